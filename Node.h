@@ -1,24 +1,31 @@
 #ifndef NODE_H
 #define NODE_H
 
+// Urgency levels of a food request, lowest first.
+enum Urgency { NORMAL = 0, URGENT = 1, CRITICAL = 2 };
+const int URGENCY_LEVELS = 3;
+
+// A food request. Nodes live in the Queue's slab and link to each other by
+// slot index rather than by pointer.
 class NODE {
     int id;          // Changed from 'data' to 'id' to match your usage
     int quantity;
-    NODE* nextPtr;
+    int urgency;
+    int next;        // slot of the next node, -1 at the end
 public:
-    NODE(int x, int y) : id(x), quantity(y), nextPtr(nullptr) {}
-    ~NODE() = default;
+    NODE(int x, int y, int level = NORMAL) : id(x), quantity(y), urgency(level), next(-1) {}
+    NODE() : NODE(0, 0) {}
     
     // Setters
-    void set_next(NODE* next) { nextPtr = next; }
+    void set_next(int slot) { next = slot; }
+    void set_quantity(int q) { quantity = q; }
     
     // Getters
-    NODE* get_next() const { return nextPtr; }
+    int get_next() const { return next; }
     int get_value() const { return quantity; }
     int get_id() const { return id; }
     int get_quantity() const { return quantity; }
+    int get_urgency() const { return urgency; }
 };
 
-typedef NODE* NodePtr;
-
-#endif
\ No newline at end of file
+#endif
@@ -1,52 +1,98 @@
 #include "Queue.h"
 #include <iostream>
 
-Queue::Queue() : headPtr(nullptr), tailPtr(nullptr), size(0) {}
+static const char* URGENCY_NAMES[URGENCY_LEVELS] = {"Normal", "Urgent", "Critical"};
 
-Queue::~Queue() {
-    while (!isEmpty()) {
-        dequeue();
+Queue::Queue() : freeList(-1), size(0) {
+    for (int level = 0; level < URGENCY_LEVELS; level++) {
+        head[level] = tail[level] = -1;
+        levelSize[level] = 0;
     }
 }
 
-void Queue::enqueue(int x, int y, bool isUrgent) {
-    NodePtr new_node = new NODE(x, y);
-    if (isUrgent) {
-        new_node->set_next(headPtr);
-        headPtr = new_node;
-        if (!tailPtr) tailPtr = headPtr;
-    } else {
-        if (tailPtr) tailPtr->set_next(new_node);
-        else headPtr = new_node;
-        tailPtr = new_node;
+int Queue::allocate(int id, int quantity, int urgency) {
+    if (freeList == -1) {
+        slab.emplace_back(id, quantity, urgency);
+        return static_cast<int>(slab.size()) - 1;
     }
+    int slot = freeList;
+    freeList = slab[slot].get_next();
+    slab[slot] = NODE(id, quantity, urgency);
+    return slot;
+}
+
+void Queue::enqueue(int id, int quantity, int urgency) {
+    if (urgency < NORMAL) urgency = NORMAL;
+    if (urgency > CRITICAL) urgency = CRITICAL;
+
+    int slot = allocate(id, quantity, urgency);
+    if (tail[urgency] != -1) slab[tail[urgency]].set_next(slot);
+    else head[urgency] = slot;
+    tail[urgency] = slot;
+    levelSize[urgency]++;
     size++;
 }
 
-NodePtr Queue::dequeue() {
-    if (isEmpty()) return nullptr;
-    
-    NodePtr temp = headPtr;
-    headPtr = headPtr->get_next();
-    if (!headPtr) tailPtr = nullptr;
+// Unlinks the head of a non-empty level and puts its slot on the free list.
+void Queue::release(int level) {
+    int slot = head[level];
+    head[level] = slab[slot].get_next();
+    if (head[level] == -1) tail[level] = -1;
+    slab[slot].set_next(freeList);
+    freeList = slot;
+    levelSize[level]--;
     size--;
-    
-    return temp;
+}
+
+bool Queue::dequeue(NODE& request) {
+    for (int level = CRITICAL; level >= NORMAL; level--) {
+        if (dequeue(level, request)) return true;
+    }
+    return false;
+}
+
+bool Queue::dequeue(int urgency, NODE& request) {
+    if (head[urgency] == -1) return false;
+    request = slab[head[urgency]];
+    release(urgency);
+    return true;
+}
+
+NODE* Queue::front() {
+    for (int level = CRITICAL; level >= NORMAL; level--) {
+        if (head[level] != -1) return &slab[head[level]];
+    }
+    return nullptr;
+}
+
+NODE* Queue::front(int urgency) {
+    return head[urgency] == -1 ? nullptr : &slab[head[urgency]];
 }
 
 int Queue::getSize() const {
     return size;
 }
 
+int Queue::getSize(int urgency) const {
+    return levelSize[urgency];
+}
+
 bool Queue::isEmpty() const {
     return size == 0;
 }
 
+void Queue::quantities(int urgency, std::vector<int>& out) const {
+    for (int slot = head[urgency]; slot != -1; slot = slab[slot].get_next()) {
+        out.push_back(slab[slot].get_quantity());
+    }
+}
+
 void Queue::displayRequests() const {
-    NodePtr current = headPtr;
-    while (current) {
-        std::cout << "Request ID: " << current->get_id() 
-                  << " | Quantity: " << current->get_quantity() << "kg\n";
-        current = current->get_next();
+    for (int level = CRITICAL; level >= NORMAL; level--) {
+        for (int slot = head[level]; slot != -1; slot = slab[slot].get_next()) {
+            std::cout << "Request ID: " << slab[slot].get_id()
+                      << " | Quantity: " << slab[slot].get_quantity() << "kg"
+                      << " | " << URGENCY_NAMES[level] << "\n";
+        }
     }
-}
\ No newline at end of file
+}
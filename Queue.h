@@ -1,23 +1,39 @@
 #ifndef QUEUE_H
 #define QUEUE_H
 
+#include <vector>
 #include "Node.h"
 
+// Food request queue with one FIFO list per urgency level. Nodes come from
+// a slab with a free list, so enqueue and dequeue are O(1) and do not
+// allocate once the slab has grown to the queue's high-water mark.
+// Requests leave the queue most urgent level first, oldest first within a
+// level.
 class Queue {
 private:
-    NodePtr headPtr, tailPtr;
+    std::vector<NODE> slab;
+    int freeList;
+    int head[URGENCY_LEVELS];
+    int tail[URGENCY_LEVELS];
+    int levelSize[URGENCY_LEVELS];
     int size;
 
+    int allocate(int id, int quantity, int urgency);
+    void release(int level);
+
 public:
     Queue();
-    ~Queue();
     
-    // Corrected method signatures:
-    void enqueue(int x, int y, bool isUrgent = false);
-    NodePtr dequeue();  // Changed from dequeue2
-    int getSize() const;  // Changed from get_size
+    void enqueue(int id, int quantity, int urgency = NORMAL);
+    bool dequeue(NODE& request);  // false when empty
+    bool dequeue(int urgency, NODE& request);
+    NODE* front();                // next request to leave, or nullptr
+    NODE* front(int urgency);     // oldest request at one level
+    int getSize() const;
+    int getSize(int urgency) const;
     bool isEmpty() const;
+    void quantities(int urgency, std::vector<int>& out) const;  // appends, oldest first
     void displayRequests() const;
 };
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,346 @@
+// Benchmark harness: make bench [BENCH_SIZES="10000 100000"]
+//
+// For each size it generates a synthetic data set in bench_data/<size>/ and
+// times loading, saving, every report and the rankings against it. Report
+// output is discarded; the results go to stdout as one tab-separated row per
+// operation so runs of different versions can be diffed or joined.
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <random>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <fstream>
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <cstdio>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "donor.h"
+#include "recipient.h"
+#include "donation.h"
+#include "donation_store.h"
+#include "reporting.h"
+#include "export.h"
+#include "donation_pipeline.h"
+
+#ifndef BENCH_VERSION
+#define BENCH_VERSION "unknown"
+#endif
+
+using namespace std;
+
+const char* FOOD_TYPES[] = {"rice", "bread", "milk", "eggs", "beans", "pasta", "apples",
+                            "potatoes", "cheese", "chicken", "canned-soup", "cereal"};
+const int FOOD_TYPE_COUNT = sizeof(FOOD_TYPES) / sizeof(FOOD_TYPES[0]);
+
+struct BenchOptions {
+    int runs = 3;
+    size_t threads = 1;
+    int resultsFd = STDOUT_FILENO;
+};
+
+// Writes donors.dat, recipients.dat and donations.dat for n donations in
+// the current directory: one donor per 100 donations, one recipient per
+// 10,000, five years of dates, one donation in five in money and one in
+// two hundred from a donor who no longer exists.
+void generateDataset(size_t n) {
+    mt19937 gen(static_cast<unsigned>(n));
+    size_t donorCount = max<size_t>(10, n / 100);
+    size_t recipientCount = max<size_t>(2, n / 10000);
+    uniform_int_distribution<size_t> donorPick(0, donorCount - 1);
+    uniform_int_distribution<size_t> recipientPick(0, recipientCount - 1);
+    uniform_int_distribution<int> foodPick(0, FOOD_TYPE_COUNT - 1);
+    uniform_int_distribution<int> kgPick(1, 50);
+    uniform_real_distribution<float> moneyPick(5.0f, 500.0f);
+    uniform_int_distribution<int> dayPick(0, 5 * 365 - 1);
+    uniform_int_distribution<int> percent(0, 999);
+    Date firstDay = Date::fromCivil(2021, 1, 1);
+
+    vector<int> frequency(donorCount, 0);
+    vector<float> kgReceived(recipientCount, 0), moneyReceived(recipientCount, 0);
+    vector<int> receivedCount(recipientCount, 0);
+    vector<Donation> donations;
+    donations.reserve(n);
+    for (size_t i = 0; i < n; i++) {
+        int roll = percent(gen);
+        size_t donor = donorPick(gen), rec = recipientPick(gen);
+        int donorId = roll < 5 ? static_cast<int>(donorCount + 1 + donor) : static_cast<int>(donor + 1);
+        int recipientId = static_cast<int>(101 + rec);
+        string name = "donor" + to_string(donorId);
+        string date = (firstDay + dayPick(gen)).toString();
+        if (roll < 200) {
+            float amount = moneyPick(gen);
+            donations.emplace_back(donorId, name, recipientId, amount, date);
+            moneyReceived[rec] += amount;
+        } else {
+            int kg = kgPick(gen);
+            donations.emplace_back(donorId, name, recipientId, FOOD_TYPES[foodPick(gen)], kg, date);
+            kgReceived[rec] += kg;
+        }
+        if (roll >= 5) frequency[donor]++;
+        receivedCount[rec]++;
+    }
+    DonationStore::writeBinary("donations.dat", donations);
+    remove("donations.journal");
+
+    ofstream donors("donors.dat");
+    for (size_t i = 0; i < donorCount; i++) {
+        donors << "donor" << i + 1 << " donor" << i + 1 << "@example.org " << i + 1 << " " << frequency[i] << "\n";
+    }
+    ofstream recipients("recipients.dat");
+    for (size_t i = 0; i < recipientCount; i++) {
+        recipients << 101 + i << "\nRecipient " << i + 1 << "\n" << kgReceived[i] << "\n"
+                   << receivedCount[i] << "\n" << moneyReceived[i] << "\n";
+    }
+    remove("requests.dat");
+    remove("requests.journal");
+}
+
+class BenchRunner {
+private:
+    const BenchOptions& options;
+    size_t records;
+
+    void report(const string& operation, const vector<double>& millis) {
+        double total = 0;
+        for (double ms : millis) total += ms;
+        ReportWriter out(options.resultsFd);
+        out << BENCH_VERSION << "\t" << records << "\t" << operation << "\t" << millis.size() << "\t"
+            << fixed << setprecision(3) << *min_element(millis.begin(), millis.end()) << "\t"
+            << total / millis.size() << "\t" << *max_element(millis.begin(), millis.end()) << "\n";
+    }
+
+public:
+    BenchRunner(const BenchOptions& o, size_t n) : options(o), records(n) {}
+
+    static void printHeader(int fd) {
+        ReportWriter out(fd);
+        out << "version\trecords\toperation\truns\tmin_ms\tmean_ms\tmax_ms\n";
+    }
+
+    // Times f once per run, after an untimed call to setup.
+    template <typename S, typename F>
+    void time(const string& operation, S setup, F f, int runs = 0) {
+        if (runs == 0) runs = options.runs;
+        vector<double> millis;
+        for (int i = 0; i < runs; i++) {
+            setup();
+            auto start = chrono::steady_clock::now();
+            f();
+            millis.push_back(chrono::duration<double, milli>(chrono::steady_clock::now() - start).count());
+        }
+        report(operation, millis);
+    }
+
+    template <typename F>
+    void time(const string& operation, F f, int runs = 0) {
+        time(operation, [] {}, f, runs);
+    }
+};
+
+bool copyFile(const string& from, const string& to) {
+    ifstream in(from, ios::binary);
+    ofstream out(to, ios::binary | ios::trunc);
+    return in && out << in.rdbuf();
+}
+
+// Runs producers threads that push the donations between them, round robin.
+template <typename Push>
+void produce(const vector<Donation>& donations, size_t producers, Push push) {
+    vector<thread> threads;
+    for (size_t p = 0; p < producers; p++) {
+        threads.emplace_back([&donations, p, producers, &push] {
+            for (size_t i = p; i < donations.size(); i += producers) push(donations[i]);
+        });
+    }
+    for (auto& t : threads) t.join();
+}
+
+// Times the ingestion pipeline with 1, 2, 4 and 8 producer threads. The
+// mpsc_ring rows move the donations through the ring to a consumer that
+// only pops them, which separates the cost of the queue from that of the
+// writer. Pipeline runs start from an empty donation history in pipeline/,
+// with a copy of the data set's donors and recipients.
+void benchPipeline(BenchRunner& bench, const vector<Donation>& donations) {
+    mkdir("pipeline", 0755);
+    if (!copyFile("donors.dat", "pipeline/donors.dat") || !copyFile("recipients.dat", "pipeline/recipients.dat") ||
+        chdir("pipeline") != 0) {
+        cerr << "Cannot set up the pipeline benchmark" << endl;
+        return;
+    }
+
+    unique_ptr<DonorManager> donorManager;
+    unique_ptr<RecipientLinkedList> recipients;
+    unique_ptr<Reporting> report;
+    auto teardown = [&] {
+        report.reset();
+        recipients.reset();
+        donorManager.reset();
+        GroupCommitter::instance().flush();
+    };
+    for (size_t producers : {1, 2, 4, 8}) {
+        bench.time("mpsc_ring_" + to_string(producers) + "_producers", [&] {
+            MpscRing<Donation> ring(DonationPipeline::DEFAULT_CAPACITY);
+            // Counting pops rather than watching a done flag: a pop can miss
+            // the last push just before the flag is seen set.
+            thread consumer([&ring, &donations] {
+                Donation d = Donation::fromPooled(0, StringPool::EMPTY, 0, StringPool::EMPTY, 0, 0, Date(), false);
+                size_t popped = 0;
+                while (popped < donations.size()) {
+                    if (ring.tryPop(d)) popped++;
+                }
+            });
+            produce(donations, producers, [&ring](const Donation& d) {
+                while (!ring.tryPush(d)) this_thread::yield();
+            });
+            consumer.join();
+        });
+        bench.time("ingest_pipeline_" + to_string(producers) + "_producers", [&] {
+            teardown();
+            remove("donations.dat");
+            remove("donations.journal");
+            donorManager.reset(new DonorManager);
+            recipients.reset(new RecipientLinkedList);
+            recipients->setAutoSave(false);
+            report.reset(new Reporting(*donorManager, *recipients));
+        }, [&] {
+            DonationPipeline pipeline(*donorManager, *recipients, *report);
+            produce(donations, producers, [&pipeline](const Donation& d) { pipeline.submit(d); });
+            pipeline.close();
+            GroupCommitter::instance().flush();
+        });
+    }
+    teardown();
+    if (chdir("..") != 0) cerr << "Cannot leave pipeline" << endl;
+}
+
+void runBenchmarks(size_t n, const BenchOptions& options) {
+    string dir = "bench_data/" + to_string(n);
+    mkdir("bench_data", 0755);
+    mkdir(dir.c_str(), 0755);
+    if (chdir(dir.c_str()) != 0) {
+        cerr << "Cannot use " << dir << endl;
+        return;
+    }
+
+    // The managers save when they go out of scope, and saves are written in
+    // the background with paths relative to the data set directory, so all
+    // of it has to be on disk before leaving.
+    {
+        BenchRunner bench(options, n);
+        bench.time("generate", [n] { generateDataset(n); }, 1);
+
+        bench.time("donors_load", [] { DonorManager donors; });
+        unique_ptr<DonorManager> donors;
+        bench.time("donors_save", [&donors] { donors.reset(new DonorManager); }, [&donors] {
+            donors.reset();
+            GroupCommitter::instance().flush();
+        });
+
+        DonorManager donorManager;
+        RecipientLinkedList recipients;
+        recipients.setAutoSave(false);
+        bench.time("recipients_load", [&recipients] { recipients.loadFromFile(); });
+        bench.time("reporting_load", [&donorManager, &recipients, &options] {
+            Reporting report(donorManager, recipients, options.threads);
+        });
+
+        Reporting report(donorManager, recipients, options.threads);
+        bench.time("report_donations_by_quantity", [&report] { report.generateDonationReport(0); });
+        bench.time("report_donations_by_date", [&report] { report.generateDonationReport(1); });
+        bench.time("report_donations_by_money", [&report] { report.generateDonationReport(2); });
+        bench.time("report_donations_first_page", [&report] {
+            DonationPager pager = report.pageDonations(ORDER_QUANTITY);
+            report.printDonationPage(pager);
+        });
+        bench.time("report_distribution", [&report] { report.generateDistributionReport(); });
+        bench.time("report_donors", [&report] { report.generateDonorReport(); });
+        bench.time("report_overall_summary", [&report] { report.generateOverallSummary(); });
+        bench.time("report_distribution_summary", [&report] { report.generateDistributionSummary(); });
+        Date lastMonth = Date::fromCivil(2025, 12, 1);
+        bench.time("report_date_range_month", [&report, lastMonth] {
+            report.generateDateRangeReport(lastMonth, lastMonth + 30);
+        });
+        bench.time("report_audit", [&report] { report.generateAuditReport(); });
+        static const char* KEY_NAMES[] = {"donor", "recipient", "food_type", "year", "month"};
+        for (int key = GROUP_DONOR; key <= GROUP_MONTH; key++) {
+            bench.time(string("report_breakdown_") + KEY_NAMES[key], [&report, key] {
+                report.generateBreakdownReport(static_cast<GroupKey>(key), MEASURE_ALL);
+            });
+        }
+
+        size_t allDonors = donorManager.getDonors().size();
+        bench.time("rank_frequency_top10", [&report] { report.rankByDonationFrequency(10); });
+        bench.time("rank_kg_top10", [&report] { report.rankByTotalKgDonated(10); });
+        bench.time("rank_money_top10", [&report] { report.rankByTotalMoneyDonated(10); });
+        bench.time("rank_frequency_all", [&report, allDonors] { report.rankByDonationFrequency(allDonors); });
+        bench.time("rank_kg_all", [&report, allDonors] { report.rankByTotalKgDonated(allDonors); });
+        bench.time("rank_money_all", [&report, allDonors] { report.rankByTotalMoneyDonated(allDonors); });
+
+        bench.time("export_donations_csv", [&report] {
+            exportToFile("donations.csv", [&report](ostream& out) {
+                exportDonations(out, EXPORT_CSV, report.getDonations());
+            });
+        });
+        bench.time("export_donations_json", [&report] {
+            exportToFile("donations.json", [&report](ostream& out) {
+                exportDonations(out, EXPORT_JSON, report.getDonations());
+            });
+        });
+
+        benchPipeline(bench, report.getDonations());
+
+        // Removes the orphaned donations, so it only runs once per data set.
+        bench.time("cleanup_orphaned_donations", [&report, &donorManager, &recipients] {
+            report.cleanupOrphanedDonations(donorManager, recipients);
+        }, 1);
+    }
+    GroupCommitter::instance().flush();
+
+    if (chdir("../..") != 0) cerr << "Cannot leave " << dir << endl;
+}
+
+void printBenchUsage(const char* program) {
+    cerr << "Usage: " << program << " [--runs n] [--threads n] <records>...\n";
+}
+
+int main(int argc, char* argv[]) {
+    BenchOptions options;
+    vector<size_t> sizes;
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if (arg == "--runs" && i + 1 < argc) {
+            options.runs = max(1, atoi(argv[++i]));
+        } else if (arg == "--threads" && i + 1 < argc) {
+            options.threads = static_cast<size_t>(max(1, atoi(argv[++i])));
+        } else if (!arg.empty() && isdigit(static_cast<unsigned char>(arg[0]))) {
+            sizes.push_back(strtoull(arg.c_str(), nullptr, 10));
+        } else {
+            printBenchUsage(argv[0]);
+            return 1;
+        }
+    }
+    if (sizes.empty()) sizes = {10000, 100000, 1000000};
+
+    // Reports and status messages print to stdout; keep the table apart
+    // from them and send the rest to /dev/null.
+    verbosity() = VERBOSITY_QUIET;
+    cout.flush();
+    options.resultsFd = dup(STDOUT_FILENO);
+    int devNull = open("/dev/null", O_WRONLY);
+    if (options.resultsFd < 0 || devNull < 0 || dup2(devNull, STDOUT_FILENO) < 0) {
+        cerr << "Cannot redirect report output" << endl;
+        return 1;
+    }
+    close(devNull);
+
+    BenchRunner::printHeader(options.resultsFd);
+    for (size_t n : sizes) runBenchmarks(n, options);
+    cout.flush();
+    return 0;
+}
@@ -0,0 +1,108 @@
+#ifndef DATE_H
+#define DATE_H
+
+#include <string>
+#include <cstdint>
+#include <cstdio>
+#include <ctime>
+
+// Dates as day numbers (days since 01-01-1970) in the proleptic Gregorian
+// calendar, and the conversions to and from year/month/day.
+
+const int32_t INVALID_DAY_NUMBER = INT32_MIN;
+
+int32_t daysFromCivil(int year, unsigned month, unsigned day) {
+    year -= month <= 2;
+    const int era = (year >= 0 ? year : year - 399) / 400;
+    const unsigned yoe = static_cast<unsigned>(year - era * 400);
+    const unsigned doy = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+    const unsigned doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + static_cast<int>(doe) - 719468;
+}
+
+void civilFromDays(int32_t days, int& year, unsigned& month, unsigned& day) {
+    days += 719468;
+    const int era = (days >= 0 ? days : days - 146096) / 146097;
+    const unsigned doe = static_cast<unsigned>(days - era * 146097);
+    const unsigned yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    const unsigned doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    const unsigned mp = (5 * doy + 2) / 153;
+    day = doy - (153 * mp + 2) / 5 + 1;
+    month = mp < 10 ? mp + 3 : mp - 9;
+    year = static_cast<int>(yoe) + era * 400 + (month <= 2);
+}
+
+// A calendar date held as a day number. Parsing and validation happen once;
+// after that comparisons are integer comparisons and dayNumber() doubles as
+// the sort key.
+class Date {
+private:
+    int32_t days;
+
+    static bool isLeapYear(int year) {
+        return (year % 4 == 0 && year % 100 != 0) || year % 400 == 0;
+    }
+
+public:
+    Date() : days(INVALID_DAY_NUMBER) {}
+    explicit Date(int32_t dayNumber) : days(dayNumber) {}
+
+    static unsigned daysInMonth(int year, unsigned month) {
+        static const unsigned DAYS[] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+        return month == 2 && isLeapYear(year) ? 29 : DAYS[month - 1];
+    }
+
+    // Parses DD-MM-YYYY. The result is invalid unless the string has that
+    // exact shape and names a real calendar day.
+    static Date parse(const std::string& text) {
+        if (text.size() != 10 || text[2] != '-' || text[5] != '-') return Date();
+        static const int DIGITS[] = {0, 1, 3, 4, 6, 7, 8, 9};
+        for (int pos : DIGITS) {
+            if (text[pos] < '0' || text[pos] > '9') return Date();
+        }
+        unsigned day = (text[0] - '0') * 10 + (text[1] - '0');
+        unsigned month = (text[3] - '0') * 10 + (text[4] - '0');
+        int year = (text[6] - '0') * 1000 + (text[7] - '0') * 100 + (text[8] - '0') * 10 + (text[9] - '0');
+        if (month < 1 || month > 12 || day < 1 || day > daysInMonth(year, month)) return Date();
+        return Date(daysFromCivil(year, month, day));
+    }
+
+    static Date fromCivil(int year, unsigned month, unsigned day) {
+        return Date(daysFromCivil(year, month, day));
+    }
+
+    // The current local date.
+    static Date today() {
+        std::time_t now = std::time(nullptr);
+        std::tm local = *std::localtime(&now);
+        return fromCivil(local.tm_year + 1900, local.tm_mon + 1, local.tm_mday);
+    }
+
+    bool isValid() const { return days != INVALID_DAY_NUMBER; }
+    int32_t dayNumber() const { return days; }
+
+    int year() const { int y; unsigned m, d; civilFromDays(days, y, m, d); return y; }
+    int month() const { int y; unsigned m, d; civilFromDays(days, y, m, d); return static_cast<int>(m); }
+    int day() const { int y; unsigned m, d; civilFromDays(days, y, m, d); return static_cast<int>(d); }
+
+    std::string toString() const {
+        if (!isValid()) return "";
+        int y;
+        unsigned m, d;
+        civilFromDays(days, y, m, d);
+        char buf[16];
+        std::snprintf(buf, sizeof(buf), "%02u-%02u-%04d", d, m, y);
+        return buf;
+    }
+
+    Date operator+(int32_t n) const { return Date(days + n); }
+
+    bool operator==(const Date& other) const { return days == other.days; }
+    bool operator!=(const Date& other) const { return days != other.days; }
+    bool operator<(const Date& other) const { return days < other.days; }
+    bool operator>(const Date& other) const { return days > other.days; }
+    bool operator<=(const Date& other) const { return days <= other.days; }
+    bool operator>=(const Date& other) const { return days >= other.days; }
+};
+
+#endif
@@ -0,0 +1,126 @@
+#ifndef DISTRIBUTION_SCHEDULER_H
+#define DISTRIBUTION_SCHEDULER_H
+
+#include <iostream>
+#include <vector>
+#include <algorithm>
+#include <set>
+#include <utility>
+#include <unordered_set>
+#include "recipient.h"
+
+struct DistributionSummary {
+    int stockBefore = 0;
+    int stockAfter = 0;
+    int kgByLevel[URGENCY_LEVELS] = {0, 0, 0};
+    int filledByLevel[URGENCY_LEVELS] = {0, 0, 0};
+    size_t partialRequests = 0;
+    size_t recipientsServed = 0;
+    size_t pendingAfter = 0;
+
+    void print() const {
+        static const char* LEVELS[URGENCY_LEVELS] = {"Normal", "Urgent", "Critical"};
+        std::cout << "\n=== Distribution Day Summary ===\n"
+                  << "Stock available: " << stockBefore << " kg\n";
+        for (int level = CRITICAL; level >= NORMAL; level--) {
+            std::cout << LEVELS[level] << ": " << filledByLevel[level] << " requests filled, "
+                      << kgByLevel[level] << " kg\n";
+        }
+        std::cout << "Total distributed: " << stockBefore - stockAfter << " kg to "
+                  << recipientsServed << " recipients\n"
+                  << "Partially filled requests: " << partialRequests << "\n"
+                  << "Requests still pending: " << pendingAfter << "\n"
+                  << "Stock remaining: " << stockAfter << " kg\n"
+                  << "================================\n";
+    }
+};
+
+// Hands out a fixed amount of stock against the pending requests of every
+// recipient in one pass. Urgency levels are served most urgent first. Within
+// a level the remaining stock is split evenly across the recipients still
+// waiting, round after round, and each recipient's share goes to its
+// requests in FIFO order. A request the share does not cover is reduced and
+// stays at the front of its queue. Request changes are journaled as they
+// happen; the caller writes the recipients file once afterwards.
+class DistributionScheduler {
+private:
+    RecipientLinkedList& recipients;
+    DistributionSummary summary;
+    std::set<std::pair<int, int>> partial;  // (recipient, level) with a reduced front request
+    std::unordered_set<int> served;
+    int stock;
+
+    void serve(recipient& rec, int level, int allowance) {
+        int given = 0;
+        while (allowance > 0) {
+            const NODE* request = rec.front_request(level);
+            if (!request) break;
+
+            int owed = request->get_quantity();
+            if (owed <= 0) {
+                // Older builds queued requests for nothing or less; they
+                // would hand stock back, so they are dropped unserved.
+                NODE dropped;
+                rec.complete_request(level, dropped);
+                continue;
+            }
+            int take = std::min(allowance, owed);
+            allowance -= take;
+            given += take;
+            if (take == owed) {
+                partial.erase(std::make_pair(rec.get_id(), level));
+                NODE done;
+                rec.complete_request(level, done);
+                summary.filledByLevel[level]++;
+            } else {
+                rec.reduce_request(level, owed - take);
+                partial.insert(std::make_pair(rec.get_id(), level));
+            }
+        }
+        if (given > 0) {
+            rec.receive_food(given);
+            served.insert(rec.get_id());
+            summary.kgByLevel[level] += given;
+            stock -= given;
+        }
+    }
+
+public:
+    explicit DistributionScheduler(RecipientLinkedList& r) : recipients(r), stock(0) {}
+
+    DistributionSummary run(int availableKg) {
+        summary = DistributionSummary();
+        partial.clear();
+        served.clear();
+        stock = availableKg;
+        summary.stockBefore = availableKg;
+
+        std::vector<recipient*> active;
+        for (int level = CRITICAL; level >= NORMAL && stock > 0; level--) {
+            active.clear();
+            for (auto& node : recipients) {
+                if (node.rec.pending_requests(level) > 0) active.push_back(&node.rec);
+            }
+
+            while (stock > 0 && !active.empty()) {
+                int share = std::max(1, stock / static_cast<int>(active.size()));
+                size_t waiting = 0;
+                for (recipient* rec : active) {
+                    if (stock > 0) serve(*rec, level, std::min(share, stock));
+                    if (rec->pending_requests(level) > 0) active[waiting++] = rec;
+                }
+                active.resize(waiting);
+            }
+        }
+
+        summary.stockAfter = stock;
+        summary.partialRequests = partial.size();
+        summary.recipientsServed = served.size();
+        for (const auto& node : recipients) {
+            summary.pendingAfter += node.rec.pending_requests();
+        }
+        return summary;
+    }
+};
+
+#endif
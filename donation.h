@@ -5,57 +5,74 @@
 #include <string>
 #include <vector>
 #include <fstream>
+#include <cstdint>
+#include "date.h"
+#include "string_pool.h"
+#include "inventory.h"
+#include "perf_stats.h"
 #include "recipient.h"
 #include "donor.h"
 
+bool isValidDate(const std::string& date) {
+    return Date::parse(date).isValid();
+}
+
+// A donation record is 32 bytes: donor names and food types are interned
+// in the StringPool and the date is kept as a day number, so copying or
+// sorting donations never allocates.
 class Donation {
 private:
-    std::string donorName;
+    int donorId;
     int recipientId;
-    std::string foodType;
+    uint32_t donorNameId;
+    uint32_t foodTypeId;
     int quantity;
-    std::string date;
-    bool isMoney;
     float moneyAmount;
-    int donorId;
+    Date date;
+    bool isMoney;
+
+    Donation(int dId, uint32_t nameId, int rId, uint32_t foodId, int qty, float amount,
+             Date dt, bool money)
+    : donorId(dId), recipientId(rId), donorNameId(nameId), foodTypeId(foodId),
+      quantity(qty), moneyAmount(amount), date(dt), isMoney(money) {}
 
 public:
     // Constructor for food donation
-    Donation(int dId, std::string dName, int rId, std::string fType, int qty, std::string dt)
-    : donorId(dId), donorName(dName), recipientId(rId), foodType(fType), 
-      quantity(qty), date(dt), isMoney(false), moneyAmount(0) {}
+    Donation(int dId, const std::string& dName, int rId, const std::string& fType, int qty, const std::string& dt)
+    : Donation(dId, StringPool::instance().intern(dName), rId, StringPool::instance().intern(fType),
+               qty, 0, Date::parse(dt), false) {}
 
     // Constructor for money donation
-    Donation(int dId, std::string dName, int rId, float amount, std::string dt)
-    : donorId(dId), donorName(dName), recipientId(rId), foodType(""), quantity(0), date(dt), 
-      isMoney(true), moneyAmount(amount) {}
+    Donation(int dId, const std::string& dName, int rId, float amount, const std::string& dt)
+    : Donation(dId, StringPool::instance().intern(dName), rId, StringPool::EMPTY,
+               0, amount, Date::parse(dt), true) {}
+
+    // Builds a donation from already interned strings and a parsed date.
+    static Donation fromPooled(int dId, uint32_t nameId, int rId, uint32_t foodId, int qty,
+                               float amount, Date dt, bool money) {
+        return Donation(dId, nameId, rId, foodId, qty, amount, dt, money);
+    }
 
      // File I/O
-     void save(std::ofstream& out) const {
+     void save(std::ostream& out) const {
         out << donorId << "\n"
-            << donorName << "\n"
+            << getDonorName() << "\n"
             << recipientId << "\n"
-            << foodType << "\n"
+            << getFoodType() << "\n"
             << quantity << "\n"
-            << date << "\n"
+            << getDate() << "\n"
             << isMoney << "\n"
             << moneyAmount << "\n";
-        
-        // Add debug output
-        std::cout << "DEBUG: Saving donation - "
-          << "Donor: " << donorName 
-          << ", Recipient: " << recipientId
-          << ", Type: " << (isMoney ? "Money" : "Food")
-          << ", Amount: " << (isMoney ? moneyAmount : quantity)
-          << std::endl;
     }
 
-    static Donation load(std::ifstream& in) {
+    // Reads one save() record into out. Returns false, leaving out as it
+    // was, if the stream ends or fails partway through the record.
+    static bool load(std::istream& in, Donation& out) {
         std::string name, food, date;
-        int id, qty;
-        float money;
-        bool isMoney;
-        int donorId;
+        int id = 0, qty = 0;
+        float money = 0;
+        bool isMoney = false;
+        int donorId = 0;
         in >> donorId; in.ignore();
         
         std::getline(in, name);
@@ -64,57 +81,58 @@ public:
         in >> qty; in.ignore();
         std::getline(in, date);
         in >> isMoney; in.ignore();
-        in >> money; in.ignore();
+        in >> money;
+        if (!in || in.get() != '\n') return false;
         
         if (isMoney) {
-            return Donation(donorId, name, id, money, date);
+            out = Donation(donorId, name, id, money, date);
         } else {
-            return Donation(donorId, name, id, food, qty, date);
+            out = Donation(donorId, name, id, food, qty, date);
         }
+        return true;
     }
 
     // Getters
-    std::string getDonorName() const { return donorName; }
+    const std::string& getDonorName() const { return StringPool::instance().get(donorNameId); }
     int getRecipientId() const { return recipientId; }
-    std::string getFoodType() const { return foodType; }
+    const std::string& getFoodType() const { return StringPool::instance().get(foodTypeId); }
     int getQuantity() const { return quantity; }
-    std::string getDate() const { return date; }
+    std::string getDate() const { return date.toString(); }
+    Date getDateValue() const { return date; }
+    int32_t getDayNumber() const { return date.dayNumber(); }
+    uint32_t getDonorNameId() const { return donorNameId; }
+    uint32_t getFoodTypeId() const { return foodTypeId; }
     bool isMoneyDonation() const { return isMoney; }
     float getMoneyAmount() const { return moneyAmount; }
     int getDonorId() const { return donorId; }
 
-    void printDetails() const {
+    void printDetails(std::ostream& out = std::cout) const {
         if (isMoney) {
-            std::cout << "Date: " << date << " | "
-                  << "Donor: " << donorName << " | "
+            out << "Date: " << getDate() << " | "
+                  << "Donor: " << getDonorName() << " | "
                   << "Recipient ID: " << recipientId << " | "
                   << "Donation: Money | "
-                  << "Amount: $" << std::fixed << std::setprecision(2) << moneyAmount << std::endl;
+                  << "Amount: $" << std::fixed << std::setprecision(2) << moneyAmount << "\n";
         } else {
-            std::cout << "Date: " << date << " | "
-                  << "Donor: " << donorName << " | "
+            out << "Date: " << getDate() << " | "
+                  << "Donor: " << getDonorName() << " | "
                   << "Recipient ID: " << recipientId << " | "
-                  << "Food: " << foodType << " | "
-                  << "Quantity: " << quantity << " kg" << std::endl;
+                  << "Food: " << getFoodType() << " | "
+                  << "Quantity: " << quantity << " kg\n";
         }
     }
 
-int getYear() const { return stoi(date.substr(6, 4)); } // YYYY
-int getMonth() const { return stoi(date.substr(3, 2)); } // MM
-int getDay() const { return stoi(date.substr(0, 2)); }   // DD
+int getYear() const { return date.year(); }   // YYYY
+int getMonth() const { return date.month(); } // MM
+int getDay() const { return date.day(); }     // DD
 
 bool isNewerThan(const Donation& other) const {
-    // Compare years
-    if (getYear() != other.getYear()) 
-        return getYear() > other.getYear();
-    // Compare months if same year
-    if (getMonth() != other.getMonth())
-        return getMonth() > other.getMonth();
-    // Compare days if same month/year
-    return getDay() > other.getDay();
+    return date > other.date;
 }
 };
 
+static_assert(sizeof(Donation) == 32, "Donation should stay a compact 32-byte record");
+
 void bubbleSort(std::vector<Donation>& donations) {
     int n = donations.size();
     for (int i = 0; i < n - 1; i++) {
@@ -126,21 +144,38 @@ void bubbleSort(std::vector<Donation>& donations) {
     }
 }
 
-void processDonation(DonorManager& donorManager, RecipientLinkedList& recipients, const Donation& donation) {
-    if (donation.isMoneyDonation()) {
-        donorManager.track_money_donation(donation.getDonorName(), donation.getMoneyAmount());
-        recipient* rec = recipients.findRecipientById(donation.getRecipientId());
-        if (rec) {
-            rec->add_money(donation.getMoneyAmount());
-            rec->set_donation_count(rec->get_donation_count() + 1);
-            recipients.forceSave();
-        }
-    } else {
-        recipient* rec = recipients.findRecipientById(donation.getRecipientId());
-        if (rec) {
-            donorManager.track_donation(donation.getDonorName(), *rec, donation.getQuantity());
-            recipients.forceSave();
+// Applies a donation to the donor and recipient tallies. Pass persist = false
+// when applying many donations in a row and save the recipients once afterwards;
+// otherwise the recipients are marked dirty, which saves them now or, with
+// background saving on, soon.
+// Food donations also go into the inventory, when one is given, as a lot
+// expiring after the food type's shelf life.
+void processDonation(DonorManager& donorManager, RecipientLinkedList& recipients, const Donation& donation,
+                     Inventory* inventory = nullptr, bool persist = true) {
+    ScopedTimer timer(PERF_PROCESS_DONATION);
+    Donor* donor = donorManager.find_donor_by_id(donation.getDonorId());
+    bool changed = false;
+    {
+        auto lock = recipients.lockForUpdate();
+        if (donation.isMoneyDonation()) {
+            if (donor) donorManager.track_money_donation(*donor, donation.getMoneyAmount());
+            else std::cout << "Donor not found!" << std::endl;
+            recipient* rec = recipients.findRecipientById(donation.getRecipientId());
+            if (rec) {
+                rec->add_money(donation.getMoneyAmount());
+                rec->set_donation_count(rec->get_donation_count() + 1);
+                changed = true;
+            }
+        } else {
+            recipient* rec = recipients.findRecipientById(donation.getRecipientId());
+            if (rec) {
+                if (donor) donorManager.track_donation(*donor, *rec, donation.getQuantity());
+                else std::cout << "Donor not found!" << std::endl;
+                if (inventory) inventory->receive(donation.getFoodTypeId(), donation.getQuantity(), donation.getDateValue());
+                changed = true;
+            }
         }
     }
+    if (changed && persist) recipients.markDirty();
 }
 #endif
@@ -0,0 +1,188 @@
+#ifndef DONATION_JOURNAL_H
+#define DONATION_JOURNAL_H
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <sstream>
+#include <iostream>
+#include <cstdio>
+#include <unordered_map>
+#include <stdexcept>
+#include <unistd.h>
+#include "donation.h"
+#include "donation_store.h"
+#include "persist.h"
+
+// Append-only persistence for donations. The snapshot file (see
+// DonationStore) holds the donations as of the last compaction; the journal
+// holds everything since:
+//   G <n>        first line: the generation of the snapshot it applies to
+//   +            followed by one Donation::save() record
+//   -D <id>      removes every earlier donation from donor <id>
+//   -R <id>      removes every earlier donation to recipient <id>
+// Saving only appends, so its cost depends on the number of new records,
+// not on the size of the history. Appends go through the GroupCommitter, so
+// saves in quick succession share one write and one fsync.
+//
+// Each compaction writes the snapshot under the next generation before it
+// starts a new journal. A journal from an older generation than the snapshot
+// was already folded into it by a compaction that crashed before emptying
+// the journal, and is skipped instead of replayed. Journals without a G line
+// belong to generation 0.
+class DonationJournal {
+public:
+    enum TombstoneKind { DONOR = 'D', RECIPIENT = 'R' };
+
+private:
+    std::string snapshotFile;
+    std::string journalFile;
+    size_t journalEntries;
+    uint64_t generation;   // of the snapshot
+    bool journalCurrent;   // the journal on disk belongs to this generation
+
+    static const size_t MIN_COMPACTION_ENTRIES = 1024;
+
+    // Hands records to the GroupCommitter. A journal that is missing or
+    // left from an older generation is replaced, starting with its G line.
+    void write(const std::string& records) {
+        if (journalCurrent) {
+            GroupCommitter::instance().append(journalFile, records);
+            return;
+        }
+        GroupCommitter::instance().replace(journalFile, generationLine() + records);
+        journalCurrent = true;
+    }
+
+    std::string generationLine() const { return "G " + std::to_string(generation) + "\n"; }
+
+public:
+    DonationJournal(const std::string& snapshot, const std::string& journal)
+        : snapshotFile(snapshot), journalFile(journal), journalEntries(0), generation(0),
+          journalCurrent(false) {}
+
+    // Reads the snapshot and replays the journal on top of it. Tombstones
+    // only apply to records that came before them, so each record remembers
+    // the journal position it was added at and is dropped at the end if a
+    // later tombstone covers it. That keeps replay linear.
+    void load(std::vector<Donation>& donations) {
+        donations.clear();
+        journalEntries = 0;
+        journalCurrent = false;
+        GroupCommitter::instance().flush();
+        DonationStore::read(snapshotFile, donations, generation);
+
+        std::ifstream in(journalFile);
+        if (!in || in.peek() == EOF) return;
+        uint64_t journalGeneration = 0;
+        if (in.peek() == 'G') {
+            std::string line;
+            std::getline(in, line);
+            try {
+                if (line.size() > 2) journalGeneration = std::stoull(line.substr(2));
+            } catch (const std::exception&) {
+                std::cerr << "Ignoring a damaged generation line in " << journalFile << std::endl;
+            }
+        }
+        if (journalGeneration < generation) return;  // already in the snapshot
+        journalCurrent = true;
+
+        std::vector<size_t> addedAt(donations.size(), 0);
+        std::unordered_map<int, size_t> donorRemovedAt;
+        std::unordered_map<int, size_t> recipientRemovedAt;
+        std::string tag;
+        Donation donation = Donation::fromPooled(0, StringPool::EMPTY, 0, StringPool::EMPTY, 0, 0, Date(), false);
+        std::streamoff complete = in.tellg();  // end of the last whole entry
+        while (std::getline(in, tag)) {
+            if (tag.empty()) continue;
+            if (tag == "+") {
+                // A crash during an append can leave the last record cut
+                // short. It is dropped and cut off the journal, so later
+                // appends start on a record boundary.
+                if (!Donation::load(in, donation)) {
+                    std::cerr << "Dropping an incomplete record at the end of " << journalFile << std::endl;
+                    in.close();
+                    if (::truncate(journalFile.c_str(), static_cast<off_t>(complete)) != 0) {
+                        std::cerr << "Cannot repair " << journalFile << std::endl;
+                    }
+                    break;
+                }
+                journalEntries++;
+                donations.push_back(donation);
+                addedAt.push_back(journalEntries);
+            } else if (tag.size() > 3 && tag[0] == '-') {
+                journalEntries++;
+                try {
+                    int id = std::stoi(tag.substr(3));
+                    if (tag[1] == DONOR) donorRemovedAt[id] = journalEntries;
+                    else if (tag[1] == RECIPIENT) recipientRemovedAt[id] = journalEntries;
+                } catch (const std::exception&) {
+                    std::cerr << "Ignoring a damaged entry in " << journalFile << std::endl;
+                }
+            } else {
+                journalEntries++;
+            }
+            complete = in.tellg();
+        }
+
+        if (donorRemovedAt.empty() && recipientRemovedAt.empty()) return;
+        size_t kept = 0;
+        for (size_t i = 0; i < donations.size(); i++) {
+            auto d = donorRemovedAt.find(donations[i].getDonorId());
+            auto r = recipientRemovedAt.find(donations[i].getRecipientId());
+            bool removed = (d != donorRemovedAt.end() && d->second > addedAt[i]) ||
+                           (r != recipientRemovedAt.end() && r->second > addedAt[i]);
+            if (!removed) {
+                if (kept != i) donations[kept] = donations[i];
+                kept++;
+            }
+        }
+        donations.erase(donations.begin() + kept, donations.end());
+    }
+
+    // Appends donations[from..] to the journal.
+    void append(const std::vector<Donation>& donations, size_t from) {
+        if (from >= donations.size()) return;
+        std::ostringstream out;
+        for (size_t i = from; i < donations.size(); i++) {
+            out << "+\n";
+            donations[i].save(out);
+        }
+        write(out.str());
+        journalEntries += donations.size() - from;
+    }
+
+    void appendTombstone(TombstoneKind kind, int id) {
+        std::ostringstream out;
+        out << '-' << static_cast<char>(kind) << ' ' << id << "\n";
+        write(out.str());
+        journalEntries++;
+    }
+
+    // Compaction is worth it once the journal is longer than the live data.
+    bool needsCompaction(size_t liveCount) const {
+        return journalEntries >= MIN_COMPACTION_ENTRIES && journalEntries > liveCount;
+    }
+
+    // Folds the journal into a fresh snapshot of the live donations. Pending
+    // appends are committed first, and the new snapshot, stamped with the
+    // next generation, is on disk before the journal is restarted under that
+    // generation. A crash in between leaves a journal the next load skips,
+    // so no record is lost or applied twice.
+    void compact(const std::vector<Donation>& donations) {
+        GroupCommitter::instance().flush();
+        std::string tmpFile = snapshotFile + ".tmp";
+        if (!DonationStore::writeBinary(tmpFile, donations, generation + 1) || !syncFile(tmpFile) || std::rename(tmpFile.c_str(), snapshotFile.c_str()) != 0) {
+            std::cerr << "Cannot compact " << snapshotFile << "; keeping the journal" << std::endl;
+            std::remove(tmpFile.c_str());
+            return;
+        }
+        syncDirectory(directoryOf(snapshotFile));
+        generation++;
+        journalCurrent = replaceFile(journalFile, generationLine());
+        syncDirectory(directoryOf(journalFile));
+        journalEntries = 0;
+    }
+};
+
+#endif
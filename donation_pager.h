@@ -0,0 +1,91 @@
+#ifndef DONATION_PAGER_H
+#define DONATION_PAGER_H
+
+#include <vector>
+#include <numeric>
+#include <algorithm>
+#include <cstdint>
+#include "donation.h"
+
+// Donation report orders.
+enum DonationOrder { ORDER_QUANTITY, ORDER_DATE, ORDER_MONEY };
+
+// Walks the donations in report order one page at a time, without sorting
+// the whole history. Donations not yet shown sit in a heap of positions:
+// building it is linear and each page pops only its own rows, so the first
+// page costs O(n + page log n) instead of O(n log n). Newest-first order
+// reads the date index backwards instead. Rows already selected are kept,
+// so going back a page costs nothing.
+//
+// Holds positions into the donations vector, which must not change while
+// the pager is in use.
+class DonationPager {
+private:
+    const std::vector<Donation>& donations;
+    DonationOrder order;
+    size_t pageSize;
+    std::vector<uint32_t> unread;         // heap, or the date index
+    std::vector<uint32_t> selected;       // in report order
+    size_t current;                       // page shown last
+
+    // True when a belongs after b in the report.
+    bool after(uint32_t a, uint32_t b) const {
+        const Donation& x = donations[a];
+        const Donation& y = donations[b];
+        if (order == ORDER_MONEY) {
+            if (x.isMoneyDonation() != y.isMoneyDonation()) return y.isMoneyDonation();
+            return x.getMoneyAmount() < y.getMoneyAmount();
+        }
+        return x.getQuantity() < y.getQuantity();
+    }
+
+    // Selects rows until page is complete or the donations run out.
+    void selectThrough(size_t page) {
+        size_t wanted = std::min(donations.size(), (page + 1) * pageSize);
+        while (selected.size() < wanted) {
+            if (order == ORDER_DATE) {
+                selected.push_back(unread[unread.size() - 1 - selected.size()]);
+            } else {
+                std::pop_heap(unread.begin(), unread.end(),
+                              [this](uint32_t a, uint32_t b) { return after(a, b); });
+                selected.push_back(unread.back());
+                unread.pop_back();
+            }
+        }
+    }
+
+public:
+    // dateIndex holds the positions ordered by date, oldest first; it is
+    // only read for ORDER_DATE.
+    DonationPager(const std::vector<Donation>& d, DonationOrder o, const std::vector<uint32_t>& dateIndex,
+                  size_t size = 20)
+        : donations(d), order(o), pageSize(std::max<size_t>(1, size)), current(0) {
+        if (order == ORDER_DATE) {
+            unread = dateIndex;
+        } else {
+            unread.resize(donations.size());
+            std::iota(unread.begin(), unread.end(), 0);
+            std::make_heap(unread.begin(), unread.end(),
+                           [this](uint32_t a, uint32_t b) { return after(a, b); });
+        }
+        selected.reserve(std::min(donations.size(), pageSize));
+    }
+
+    size_t pageCount() const { return (donations.size() + pageSize - 1) / pageSize; }
+    size_t page() const { return current; }
+    bool hasNext() const { return current + 1 < pageCount(); }
+    bool hasPrev() const { return current > 0; }
+
+    void next() { if (hasNext()) current++; }
+    void prev() { if (hasPrev()) current--; }
+
+    // Calls f for each donation on the current page, in report order.
+    template <typename F>
+    void forEachOnPage(F f) {
+        selectThrough(current);
+        size_t end = std::min(selected.size(), (current + 1) * pageSize);
+        for (size_t i = current * pageSize; i < end; i++) f(donations[selected[i]]);
+    }
+};
+
+#endif
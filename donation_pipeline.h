@@ -0,0 +1,112 @@
+#ifndef DONATION_PIPELINE_H
+#define DONATION_PIPELINE_H
+
+#include <atomic>
+#include <thread>
+#include <chrono>
+#include <cstdint>
+#include "mpsc_ring.h"
+#include "donor.h"
+#include "recipient.h"
+#include "donation.h"
+#include "inventory.h"
+#include "reporting.h"
+
+// Ingestion from many threads without locking the managers. Producers push
+// validated donations into a bounded lock-free ring; one writer thread owns
+// DonorManager, RecipientLinkedList, Reporting and the inventory for the
+// life of the pipeline, applies the donations in batches and saves after
+// each batch, so a burst costs one save rather than one per donation.
+//
+// While it runs, other threads must not touch the managers except to look
+// donors and recipients up for validation, and must not add or remove
+// either. Building a Donation from strings interns them in the
+// StringPool, which is not thread-safe; producers should intern up front
+// and use Donation::fromPooled().
+class DonationPipeline {
+private:
+    DonorManager& donorManager;
+    RecipientLinkedList& recipients;
+    Reporting& report;
+    Inventory* inventory;
+    MpscRing<Donation> ring;
+    size_t batchSize;
+    std::atomic<uint64_t> submitted;
+    std::atomic<uint64_t> applied;   // applied and handed to the savers
+    std::atomic<bool> stopping;
+    std::thread writer;
+
+    void persist() {
+        report.forceSaveAll();
+        donorManager.saveDonors();
+        recipients.markDirty();
+        if (inventory) inventory->save();
+    }
+
+    void run() {
+        // Spin briefly when idle, then back off to short sleeps so an idle
+        // pipeline does not burn a core.
+        int idleRounds = 0;
+        Donation donation = Donation::fromPooled(0, StringPool::EMPTY, 0, StringPool::EMPTY, 0, 0, Date(), false);
+        while (true) {
+            size_t count = 0;
+            while (count < batchSize && ring.tryPop(donation)) {
+                processDonation(donorManager, recipients, donation, inventory, false);
+                report.addDonation(donation);
+                count++;
+            }
+            if (count > 0) {
+                persist();
+                applied.fetch_add(count, std::memory_order_release);
+                idleRounds = 0;
+                continue;
+            }
+            if (stopping.load(std::memory_order_acquire) &&
+                applied.load(std::memory_order_relaxed) == submitted.load(std::memory_order_acquire)) {
+                return;
+            }
+            if (++idleRounds < 64) std::this_thread::yield();
+            else std::this_thread::sleep_for(std::chrono::microseconds(100));
+        }
+    }
+
+public:
+    static const size_t DEFAULT_CAPACITY = 65536;
+    static const size_t DEFAULT_BATCH = 4096;
+
+    DonationPipeline(DonorManager& dm, RecipientLinkedList& r, Reporting& rep, Inventory* inv = nullptr,
+                     size_t capacity = DEFAULT_CAPACITY, size_t batch = DEFAULT_BATCH)
+        : donorManager(dm), recipients(r), report(rep), inventory(inv), ring(capacity),
+          batchSize(batch == 0 ? 1 : batch), submitted(0), applied(0), stopping(false) {
+        writer = std::thread(&DonationPipeline::run, this);
+    }
+
+    ~DonationPipeline() { close(); }
+
+    DonationPipeline(const DonationPipeline&) = delete;
+    DonationPipeline& operator=(const DonationPipeline&) = delete;
+
+    // Any thread. Waits for room while the ring is full.
+    void submit(const Donation& donation) {
+        submitted.fetch_add(1, std::memory_order_release);
+        while (!ring.tryPush(donation)) std::this_thread::yield();
+    }
+
+    // Waits until every donation submitted so far has been applied.
+    void flush() {
+        uint64_t target = submitted.load(std::memory_order_acquire);
+        while (applied.load(std::memory_order_acquire) < target) std::this_thread::yield();
+    }
+
+    // Applies what is left and stops the writer. Call once the producers
+    // are done; the managers are free for other use afterwards.
+    void close() {
+        if (!writer.joinable()) return;
+        stopping.store(true, std::memory_order_release);
+        writer.join();
+    }
+
+    uint64_t appliedCount() const { return applied.load(std::memory_order_acquire); }
+};
+
+#endif
@@ -0,0 +1,261 @@
+#ifndef DONATION_STORE_H
+#define DONATION_STORE_H
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <cstdio>
+#include <cstring>
+#include <cstdint>
+#include <cstddef>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "date.h"
+#include "string_pool.h"
+#include "donation.h"
+
+// Snapshot file formats for donations.
+//
+// Binary layout (native byte order), every section 4-byte aligned:
+//   header     "FDDB", uint32 version, uint64 count, uint32 stringCount, uint32 stringBytes,
+//              uint64 generation (version 2 only)
+//   columns    int32 donorId[count], int32 recipientId[count], int32 quantity[count],
+//              float money[count], uint32 date[count], uint32 donorName[count],
+//              uint32 foodType[count], uint8 isMoney[count] (padded)
+//   strings    uint32 offsets[stringCount + 1], char bytes[stringBytes]
+// Dates are packed as YYYYMMDD. A date that did not parse is stored as 0 and
+// loads as an invalid Date; its original text is not kept.
+// The generation is the DonationJournal generation the snapshot was compacted
+// into; version 1 files have none and count as generation 0.
+//
+// Files without the magic are read as the original text format, one
+// Donation::save() record after another.
+class DonationStore {
+private:
+    struct Header {
+        char magic[4];
+        uint32_t version;
+        uint64_t count;
+        uint32_t stringCount;
+        uint32_t stringBytes;
+        uint64_t generation;
+    };
+
+    static const size_t V1_HEADER_SIZE = offsetof(Header, generation);
+
+    static size_t padded(size_t bytes) { return (bytes + 3) & ~static_cast<size_t>(3); }
+
+    static uint32_t packDate(int32_t dayNumber) {
+        if (dayNumber == INVALID_DAY_NUMBER) return 0;
+        int year;
+        unsigned month, day;
+        civilFromDays(dayNumber, year, month, day);
+        return static_cast<uint32_t>(year) * 10000 + month * 100 + day;
+    }
+
+    static Date unpackDate(uint32_t packed) {
+        if (packed == 0) return Date();
+        return Date::fromCivil(packed / 10000, packed / 100 % 100, packed % 100);
+    }
+
+    static bool readText(const std::string& path, std::vector<Donation>& donations) {
+        std::ifstream in(path);
+        if (!in) return false;
+        Donation donation = Donation::fromPooled(0, StringPool::EMPTY, 0, StringPool::EMPTY, 0, 0, Date(), false);
+        while ((in >> std::ws).peek() != EOF) {
+            if (!Donation::load(in, donation)) {
+                std::cerr << "Ignoring an incomplete record at the end of " << path << std::endl;
+                break;
+            }
+            donations.push_back(donation);
+        }
+        return true;
+    }
+
+    static bool readBinary(const char* data, size_t size, std::vector<Donation>& donations,
+                           uint64_t& generation) {
+        Header h;
+        if (size < V1_HEADER_SIZE) return false;
+        std::memcpy(&h, data, V1_HEADER_SIZE);
+        if (h.version != 1 && h.version != VERSION) {
+            std::cerr << "Unsupported donations file version " << h.version << std::endl;
+            return false;
+        }
+        size_t headerSize = h.version == 1 ? V1_HEADER_SIZE : sizeof(Header);
+        if (size < headerSize) return false;
+        std::memcpy(&h, data, headerSize);
+        if (h.version == 1) h.generation = 0;
+
+        // Sizes come from the file, so each is checked against what is left
+        // of the mapping before anything is multiplied or added.
+        size_t available = size - headerSize;
+        if (h.count > available / (7 * sizeof(uint32_t) + 1)) {
+            std::cerr << "Donations file is truncated" << std::endl;
+            return false;
+        }
+        size_t n = static_cast<size_t>(h.count);
+        size_t columnsBytes = n * 7 * sizeof(uint32_t) + padded(n);
+        size_t offsetsBytes = (static_cast<size_t>(h.stringCount) + 1) * sizeof(uint32_t);
+        if (columnsBytes > available || offsetsBytes > available - columnsBytes ||
+            h.stringBytes > available - columnsBytes - offsetsBytes) {
+            std::cerr << "Donations file is truncated" << std::endl;
+            return false;
+        }
+
+        const char* p = data + headerSize;
+        const int32_t* donorId = reinterpret_cast<const int32_t*>(p);
+        const int32_t* recipientId = donorId + n;
+        const int32_t* quantity = recipientId + n;
+        const float* money = reinterpret_cast<const float*>(quantity + n);
+        const uint32_t* date = reinterpret_cast<const uint32_t*>(money + n);
+        const uint32_t* donorName = date + n;
+        const uint32_t* foodType = donorName + n;
+        const uint8_t* isMoney = reinterpret_cast<const uint8_t*>(foodType + n);
+        const uint32_t* offsets = reinterpret_cast<const uint32_t*>(p + n * 7 * sizeof(uint32_t) + padded(n));
+        const char* bytes = reinterpret_cast<const char*>(offsets + h.stringCount + 1);
+
+        // String offsets must run forwards within the byte section, and every
+        // record must name strings that exist.
+        bool valid = offsets[0] == 0 && offsets[h.stringCount] <= h.stringBytes;
+        for (uint32_t i = 0; valid && i < h.stringCount; i++) valid = offsets[i] <= offsets[i + 1];
+        for (size_t i = 0; valid && i < n; i++) {
+            valid = donorName[i] < h.stringCount && foodType[i] < h.stringCount;
+        }
+        if (!valid) {
+            std::cerr << "Donations file is corrupt" << std::endl;
+            return false;
+        }
+
+        // Each file string is interned once; records then only remap ids.
+        StringPool& pool = StringPool::instance();
+        std::vector<uint32_t> pooled(h.stringCount);
+        for (uint32_t i = 0; i < h.stringCount; i++) {
+            pooled[i] = pool.intern(std::string(bytes + offsets[i], offsets[i + 1] - offsets[i]));
+        }
+
+        donations.reserve(donations.size() + n);
+        for (size_t i = 0; i < n; i++) {
+            donations.push_back(Donation::fromPooled(donorId[i], pooled[donorName[i]], recipientId[i],
+                                                     pooled[foodType[i]], quantity[i], money[i],
+                                                     unpackDate(date[i]), isMoney[i] != 0));
+        }
+        generation = h.generation;
+        return true;
+    }
+
+    template <typename T>
+    static void writeColumn(std::ofstream& out, const std::vector<T>& column) {
+        out.write(reinterpret_cast<const char*>(column.data()), column.size() * sizeof(T));
+    }
+
+public:
+    static const uint32_t VERSION = 2;
+
+    static bool isBinary(const std::string& path) {
+        std::ifstream in(path, std::ios::binary);
+        char magic[4] = {};
+        in.read(magic, 4);
+        return in && std::memcmp(magic, "FDDB", 4) == 0;
+    }
+
+    // Appends the donations stored in path, in either format, to donations,
+    // and sets generation to the one the file was written with (0 for text).
+    // Returns false if the file does not exist or cannot be read.
+    static bool read(const std::string& path, std::vector<Donation>& donations, uint64_t& generation) {
+        generation = 0;
+        if (!isBinary(path)) return readText(path, donations);
+
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) return false;
+        struct stat st;
+        if (fstat(fd, &st) != 0) {
+            ::close(fd);
+            return false;
+        }
+        size_t size = static_cast<size_t>(st.st_size);
+        void* map = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (map == MAP_FAILED) return false;
+
+        madvise(map, size, MADV_SEQUENTIAL);
+        bool ok = readBinary(static_cast<const char*>(map), size, donations, generation);
+        munmap(map, size);
+        return ok;
+    }
+
+    static bool read(const std::string& path, std::vector<Donation>& donations) {
+        uint64_t generation;
+        return read(path, donations, generation);
+    }
+
+    // Returns false if the file could not be written in full.
+    static bool writeBinary(const std::string& path, const std::vector<Donation>& donations,
+                            uint64_t generation = 0) {
+        size_t n = donations.size();
+        std::vector<int32_t> donorId(n), recipientId(n), quantity(n);
+        std::vector<float> money(n);
+        std::vector<uint32_t> date(n), donorName(n), foodType(n);
+        std::vector<uint8_t> isMoney(padded(n), 0);
+
+        // Pool ids are remapped to a dense file string table.
+        const StringPool& pool = StringPool::instance();
+        const uint32_t UNMAPPED = 0xFFFFFFFFu;
+        std::vector<uint32_t> fileIds(pool.size(), UNMAPPED);
+        std::vector<uint32_t> offsets(1, 0);
+        std::string bytes;
+        auto intern = [&](uint32_t poolId) -> uint32_t {
+            if (fileIds[poolId] == UNMAPPED) {
+                fileIds[poolId] = static_cast<uint32_t>(offsets.size() - 1);
+                bytes += pool.get(poolId);
+                offsets.push_back(static_cast<uint32_t>(bytes.size()));
+            }
+            return fileIds[poolId];
+        };
+
+        for (size_t i = 0; i < n; i++) {
+            const Donation& d = donations[i];
+            donorId[i] = d.getDonorId();
+            recipientId[i] = d.getRecipientId();
+            quantity[i] = d.getQuantity();
+            money[i] = d.getMoneyAmount();
+            date[i] = packDate(d.getDayNumber());
+            donorName[i] = intern(d.getDonorNameId());
+            foodType[i] = intern(d.getFoodTypeId());
+            isMoney[i] = d.isMoneyDonation() ? 1 : 0;
+        }
+
+        Header h;
+        std::memcpy(h.magic, "FDDB", 4);
+        h.version = VERSION;
+        h.count = n;
+        h.stringCount = static_cast<uint32_t>(offsets.size() - 1);
+        h.stringBytes = static_cast<uint32_t>(bytes.size());
+        h.generation = generation;
+
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        out.write(reinterpret_cast<const char*>(&h), sizeof(h));
+        writeColumn(out, donorId);
+        writeColumn(out, recipientId);
+        writeColumn(out, quantity);
+        writeColumn(out, money);
+        writeColumn(out, date);
+        writeColumn(out, donorName);
+        writeColumn(out, foodType);
+        writeColumn(out, isMoney);
+        writeColumn(out, offsets);
+        out.write(bytes.data(), bytes.size());
+        out.flush();
+        return out.good();
+    }
+
+    // Converts a donations file in either format to the binary format.
+    static bool convert(const std::string& from, const std::string& to) {
+        std::vector<Donation> donations;
+        if (!read(from, donations)) return false;
+        return writeBinary(to, donations);
+    }
+};
+
+#endif
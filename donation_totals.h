@@ -0,0 +1,75 @@
+#ifndef DONATION_TOTALS_H
+#define DONATION_TOTALS_H
+
+#include <cmath>
+#include <unordered_map>
+#include "donation.h"
+
+// Running totals for a set of donations. Money is counted in whole cents so
+// that adding and later removing a donation restores the exact previous
+// value, whatever order the updates arrive in.
+struct DonationTally {
+    long long kg = 0;
+    long long cents = 0;
+    size_t count = 0;
+    size_t moneyCount = 0;
+
+    static long long toCents(float amount) { return std::llround(static_cast<double>(amount) * 100.0); }
+
+    void add(const Donation& d, int sign = 1) {
+        count += sign;
+        if (d.isMoneyDonation()) {
+            moneyCount += sign;
+            cents += sign * toCents(d.getMoneyAmount());
+        } else {
+            kg += sign * d.getQuantity();
+        }
+    }
+
+    void merge(const DonationTally& other) {
+        kg += other.kg;
+        cents += other.cents;
+        count += other.count;
+        moneyCount += other.moneyCount;
+    }
+
+    double money() const { return cents / 100.0; }
+};
+
+// Overall, per-donor and per-recipient tallies, kept up to date as
+// donations are added and removed so summaries never rescan the history.
+class DonationTotals {
+private:
+    DonationTally overall;
+    std::unordered_map<int, DonationTally> byDonor;
+    std::unordered_map<int, DonationTally> byRecipient;
+
+    static DonationTally lookup(const std::unordered_map<int, DonationTally>& tallies, int id) {
+        auto it = tallies.find(id);
+        return it == tallies.end() ? DonationTally() : it->second;
+    }
+
+    void update(const Donation& d, int sign) {
+        overall.add(d, sign);
+        byDonor[d.getDonorId()].add(d, sign);
+        byRecipient[d.getRecipientId()].add(d, sign);
+    }
+
+public:
+    void add(const Donation& d) { update(d, 1); }
+    void remove(const Donation& d) { update(d, -1); }
+
+    // Takes over tallies computed elsewhere, e.g. by ParallelAggregator.
+    void assign(const DonationTally& all, std::unordered_map<int, DonationTally>&& donors,
+                std::unordered_map<int, DonationTally>&& recipients) {
+        overall = all;
+        byDonor = std::move(donors);
+        byRecipient = std::move(recipients);
+    }
+
+    const DonationTally& global() const { return overall; }
+    DonationTally forDonor(int donorId) const { return lookup(byDonor, donorId); }
+    DonationTally forRecipient(int recipientId) const { return lookup(byRecipient, recipientId); }
+};
+
+#endif
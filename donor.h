@@ -5,7 +5,11 @@
 #include <string>
 #include <algorithm>
 #include <fstream>
+#include <sstream>
+#include <unordered_map>
 #include "recipient.h"
+#include "perf_stats.h"
+#include "persist.h"
 
 class Donor {
 private:
@@ -21,9 +25,9 @@ public:
         : name(n), contactDetails(contact), id(id), donationFrequency(0), temp_kg(0), moneyDonated(0) {}
 
     // Getters
-    std::string get_name() const { return name; }
+    const std::string& get_name() const { return name; }
     int get_id() const { return id; }
-    std::string get_contact_details() const { return contactDetails; }
+    const std::string& get_contact_details() const { return contactDetails; }
     int get_donation_frequency() const { return donationFrequency; }
     float get_temp_kg() const { return temp_kg; }
     float get_money_donated() const { return moneyDonated; }
@@ -43,64 +47,121 @@ public:
     }
 };
 
+// Donors are kept in a vector with hash indexes from id and from name to
+// their slot. Pointers returned by the find functions stay valid until the
+// next register_donor() or delete_donor().
 class DonorManager {
     private:
         std::vector<Donor> donors;
+        std::unordered_map<int, size_t> idIndex;
+        std::unordered_map<std::string, size_t> nameIndex;
         const std::string dataFile = "donors.dat";
+
+        void indexDonor(size_t slot) {
+            idIndex[donors[slot].get_id()] = slot;
+            nameIndex.emplace(donors[slot].get_name(), slot);
+        }
     
         void loadDonors() {
+            ScopedTimer timer(PERF_DONORS_LOAD);
+            GroupCommitter::instance().flush();
             std::ifstream file(dataFile);
             if (file) {
                 donors.clear();
+                idIndex.clear();
+                nameIndex.clear();
                 std::string name, contact;
                 int id, freq;
                 while (file >> name >> contact >> id >> freq) {
                     Donor d(name, contact, id);
                     for (int i = 0; i < freq; i++) d.increment_donation_frequency();
                     donors.push_back(d);
+                    indexDonor(donors.size() - 1);
                 }
             }
         }
     
+public:
+        DonorManager() { loadDonors(); }
+        ~DonorManager() { saveDonors(); }
+
+        // Hands the donors file to the GroupCommitter.
         void saveDonors() {
-            std::ofstream file(dataFile);
+            ScopedTimer timer(PERF_DONORS_SAVE);
+            std::ostringstream file;
             for (const auto& donor : donors) {
                 file << donor.get_name() << " "
                      << donor.get_contact_details() << " "
                      << donor.get_id() << " "
                      << donor.get_donation_frequency() << "\n";
             }
+            GroupCommitter::instance().replace(dataFile, file.str());
         }
-public:
-        DonorManager() { loadDonors(); }
-        ~DonorManager() { saveDonors(); }
     
-        void register_donor(std::string name, std::string contact, int id) {
+        // Names and ids are both used to identify donors, so neither may repeat.
+        bool register_donor(std::string name, std::string contact, int id) {
+            if (idIndex.count(id) || nameIndex.count(name)) return false;
             donors.emplace_back(name, contact, id);
+            indexDonor(donors.size() - 1);
+            return true;
+        }
+
+        Donor* find_donor_by_id(int id) {
+            auto it = idIndex.find(id);
+            return it == idIndex.end() ? nullptr : &donors[it->second];
+        }
+
+        const Donor* find_donor_by_id(int id) const {
+            auto it = idIndex.find(id);
+            return it == idIndex.end() ? nullptr : &donors[it->second];
+        }
+
+        Donor* find_donor_by_name(const std::string& name) {
+            auto it = nameIndex.find(name);
+            return it == nameIndex.end() ? nullptr : &donors[it->second];
+        }
+
+        const Donor* find_donor_by_name(const std::string& name) const {
+            auto it = nameIndex.find(name);
+            return it == nameIndex.end() ? nullptr : &donors[it->second];
+        }
+
+        void track_donation(Donor& donor, recipient& rec, int foodAmount) {
+            donor.increment_donation_frequency();
+            rec += foodAmount;
         }
     
-        void track_donation(std::string name, recipient& rec, int foodAmount) {
-            for (auto& donor : donors) {
-                if (donor.get_name() == name) {
-                    donor.increment_donation_frequency();
-                    rec += foodAmount;
-                    return;
-                }
+        void track_donation(const std::string& name, recipient& rec, int foodAmount) {
+            Donor* donor = find_donor_by_name(name);
+            if (donor) {
+                track_donation(*donor, rec, foodAmount);
+                return;
             }
             std::cout << "Donor not found!" << std::endl;
         }
     
         const std::vector<Donor>& getDonors() const { return donors; }
     
+        // Moves the last donor into the freed slot instead of shifting the
+        // whole vector, then points the indexes at its new position.
         bool delete_donor(int id) {
-            auto it = std::find_if(donors.begin(), donors.end(), 
-                [id](const Donor& d) { return d.get_id() == id; });
-            
-            if (it != donors.end()) {
-                donors.erase(it);
-                return true;
+            auto it = idIndex.find(id);
+            if (it == idIndex.end()) return false;
+
+            size_t slot = it->second;
+            auto name = nameIndex.find(donors[slot].get_name());
+            if (name != nameIndex.end() && name->second == slot) nameIndex.erase(name);
+            idIndex.erase(it);
+
+            size_t last = donors.size() - 1;
+            if (slot != last) {
+                donors[slot] = std::move(donors[last]);
+                idIndex[donors[slot].get_id()] = slot;
+                auto moved = nameIndex.find(donors[slot].get_name());
+                if (moved != nameIndex.end() && moved->second == last) moved->second = slot;
             }
-            return false;
+            donors.pop_back();
+            return true;
         }
         
         void listDonorIDs() const {
@@ -118,13 +179,16 @@ public:
             std::cout << "----------------------\n";
         }
 
-        void track_money_donation(std::string name, float amount) {
-            for (auto& donor : donors) {
-                if (donor.get_name() == name) {
-                    donor.increment_donation_frequency();
-                    donor.add_money(amount);
-                    return;
-                }
+        void track_money_donation(Donor& donor, float amount) {
+            donor.increment_donation_frequency();
+            donor.add_money(amount);
+        }
+
+        void track_money_donation(const std::string& name, float amount) {
+            Donor* donor = find_donor_by_name(name);
+            if (donor) {
+                track_money_donation(*donor, amount);
+                return;
             }
             std::cout << "Donor not found!" << std::endl;
         }
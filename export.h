@@ -0,0 +1,257 @@
+#ifndef EXPORT_H
+#define EXPORT_H
+
+#include <string>
+#include <vector>
+#include <ostream>
+#include <cmath>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include "date.h"
+#include "donation.h"
+#include "donor.h"
+#include "recipient.h"
+#include "report_writer.h"
+
+enum ExportFormat { EXPORT_CSV, EXPORT_JSON };
+
+// .json exports as JSON, anything else as CSV.
+ExportFormat exportFormatFor(const std::string& path) {
+    size_t dot = path.rfind('.');
+    return dot != std::string::npos && path.compare(dot, std::string::npos, ".json") == 0 ? EXPORT_JSON : EXPORT_CSV;
+}
+
+// Writes rows field by field straight into a stream: a CSV file with a
+// header line, or a JSON array of objects keyed by the column names.
+// Values are escaped as they are written, so no row is ever assembled in
+// memory and the cost per row is independent of how many there are. Bytes
+// go to the stream buffer directly, skipping the per-call stream sentry and
+// number formatting, which would otherwise dominate the cost of a row.
+class ExportWriter {
+private:
+    std::ostream& out;
+    std::streambuf& buffer;
+    ExportFormat format;
+    const char* const* columns;
+    size_t column;   // next column in the current row
+    size_t rows;
+    bool failed;
+
+    void put(char c) {
+        if (std::char_traits<char>::eq_int_type(buffer.sputc(c), std::char_traits<char>::eof())) failed = true;
+    }
+
+    void write(const char* data, size_t size) {
+        if (buffer.sputn(data, static_cast<std::streamsize>(size)) != static_cast<std::streamsize>(size)) {
+            failed = true;
+        }
+    }
+
+    void write(const char* text) { write(text, std::strlen(text)); }
+
+    void writeInteger(long long value) {
+        char digits[24];
+        char* end = digits + sizeof(digits);
+        char* p = end;
+        unsigned long long magnitude = value < 0 ? 0ULL - static_cast<unsigned long long>(value) : value;
+        do {
+            *--p = static_cast<char>('0' + magnitude % 10);
+            magnitude /= 10;
+        } while (magnitude > 0);
+        if (value < 0) *--p = '-';
+        write(p, static_cast<size_t>(end - p));
+    }
+
+    void writeCsv(const std::string& value) {
+        if (value.find_first_of(",\"\r\n") == std::string::npos) {
+            write(value.data(), value.size());
+            return;
+        }
+        put('"');
+        for (char c : value) {
+            if (c == '"') put('"');
+            put(c);
+        }
+        put('"');
+    }
+
+    void writeJson(const std::string& value) {
+        static const char HEX[] = "0123456789abcdef";
+        put('"');
+        for (char c : value) {
+            unsigned char u = static_cast<unsigned char>(c);
+            if (c == '"' || c == '\\') {
+                put('\\');
+                put(c);
+            } else if (c == '\n') {
+                write("\\n", 2);
+            } else if (u < 0x20) {
+                char escape[6] = {'\\', 'u', '0', '0', HEX[u >> 4], HEX[u & 0xF]};
+                write(escape, 6);
+            } else {
+                put(c);
+            }
+        }
+        put('"');
+    }
+
+    // Separator, and for JSON the key, ahead of the next value.
+    void beginField() {
+        if (format == EXPORT_JSON) {
+            write(column > 0 ? ", " : rows > 0 ? ",\n  {" : "\n  {");
+            put('"');
+            write(columns[column]);
+            write("\": ", 3);
+        } else if (column > 0) {
+            put(',');
+        }
+        column++;
+    }
+
+public:
+    // columns must stay valid while the writer is in use.
+    ExportWriter(std::ostream& o, ExportFormat f, const char* const* cols, size_t columnCount)
+        : out(o), buffer(*o.rdbuf()), format(f), columns(cols), column(0), rows(0), failed(false) {
+        if (format == EXPORT_JSON) {
+            put('[');
+            return;
+        }
+        for (size_t i = 0; i < columnCount; i++) {
+            if (i > 0) put(',');
+            write(columns[i]);
+        }
+        put('\n');
+    }
+
+    ExportWriter& field(const std::string& value) {
+        beginField();
+        if (format == EXPORT_JSON) writeJson(value);
+        else writeCsv(value);
+        return *this;
+    }
+
+    ExportWriter& field(long long value) {
+        beginField();
+        writeInteger(value);
+        return *this;
+    }
+
+    ExportWriter& field(int value) { return field(static_cast<long long>(value)); }
+
+    // Amounts and weights, rounded to two decimals.
+    ExportWriter& field(double value) {
+        beginField();
+        long long cents = std::llround(value * 100);
+        if (cents < 0) {
+            put('-');
+            cents = -cents;
+        }
+        writeInteger(cents / 100);
+        char fraction[3] = {'.', static_cast<char>('0' + cents % 100 / 10), static_cast<char>('0' + cents % 10)};
+        write(fraction, 3);
+        return *this;
+    }
+
+    // DD-MM-YYYY, the format used everywhere else. A date that never parsed
+    // is an empty CSV field or a JSON null.
+    ExportWriter& field(Date date) {
+        if (!date.isValid()) {
+            beginField();
+            if (format == EXPORT_JSON) write("null", 4);
+            return *this;
+        }
+        int y;
+        unsigned m, d;
+        civilFromDays(date.dayNumber(), y, m, d);
+        char text[12] = {'"',
+                         static_cast<char>('0' + d / 10), static_cast<char>('0' + d % 10), '-',
+                         static_cast<char>('0' + m / 10), static_cast<char>('0' + m % 10), '-',
+                         static_cast<char>('0' + y / 1000 % 10), static_cast<char>('0' + y / 100 % 10),
+                         static_cast<char>('0' + y / 10 % 10), static_cast<char>('0' + y % 10), '"'};
+        beginField();
+        if (format == EXPORT_JSON) write(text, 12);
+        else write(text + 1, 10);
+        return *this;
+    }
+
+    void endRow() {
+        put(format == EXPORT_JSON ? '}' : '\n');
+        column = 0;
+        rows++;
+    }
+
+    // Closes the JSON array and returns the number of rows written. A failed
+    // write marks the stream bad.
+    size_t finish() {
+        if (format == EXPORT_JSON) write(rows > 0 ? "\n]\n" : "]\n");
+        if (failed) out.setstate(std::ios::badbit);
+        return rows;
+    }
+};
+
+size_t exportDonations(std::ostream& out, ExportFormat format, const std::vector<Donation>& donations) {
+    static const char* COLUMNS[] = {"date", "donor_id", "donor_name", "recipient_id", "type",
+                                    "food_type", "quantity_kg", "amount"};
+    ExportWriter writer(out, format, COLUMNS, sizeof(COLUMNS) / sizeof(COLUMNS[0]));
+    static const std::string MONEY = "money", FOOD = "food", NONE;
+    for (const Donation& d : donations) {
+        bool money = d.isMoneyDonation();
+        writer.field(d.getDateValue())
+              .field(d.getDonorId())
+              .field(d.getDonorName())
+              .field(d.getRecipientId())
+              .field(money ? MONEY : FOOD)
+              .field(money ? NONE : d.getFoodType())
+              .field(money ? 0 : d.getQuantity())
+              .field(money ? static_cast<double>(d.getMoneyAmount()) : 0.0)
+              .endRow();
+    }
+    return writer.finish();
+}
+
+size_t exportDonors(std::ostream& out, ExportFormat format, const std::vector<Donor>& donors) {
+    static const char* COLUMNS[] = {"donor_id", "name", "contact", "donation_count"};
+    ExportWriter writer(out, format, COLUMNS, sizeof(COLUMNS) / sizeof(COLUMNS[0]));
+    for (const Donor& d : donors) {
+        writer.field(d.get_id())
+              .field(d.get_name())
+              .field(d.get_contact_details())
+              .field(d.get_donation_frequency())
+              .endRow();
+    }
+    return writer.finish();
+}
+
+size_t exportRecipients(std::ostream& out, ExportFormat format, const RecipientLinkedList& recipients) {
+    static const char* COLUMNS[] = {"recipient_id", "name", "total_kg", "donation_count", "total_money"};
+    ExportWriter writer(out, format, COLUMNS, sizeof(COLUMNS) / sizeof(COLUMNS[0]));
+    for (RecipientNode* node = recipients.getHead(); node; node = node->next) {
+        const recipient& r = node->rec;
+        writer.field(r.get_id())
+              .field(r.get_name())
+              .field(static_cast<double>(r.get_total_kg()))
+              .field(r.get_donation_count())
+              .field(static_cast<double>(r.get_total_money()))
+              .endRow();
+    }
+    return writer.finish();
+}
+
+// Runs write(out) against path through a ReportWriter, so memory use is one
+// output block whatever the row count. Returns false and sets errno if the
+// file cannot be written.
+template <typename F>
+bool exportToFile(const std::string& path, F write) {
+    int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) return false;
+    bool ok;
+    {
+        ReportWriter out(fd);
+        write(out);
+        ok = static_cast<bool>(out.flush());
+    }
+    return ::close(fd) == 0 && ok;
+}
+
+#endif
@@ -0,0 +1,196 @@
+#ifndef GROUP_BY_H
+#define GROUP_BY_H
+
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+#include "donation.h"
+#include "donation_totals.h"
+
+// One-pass group-by over donations. A query names any number of grouping
+// keys; a single scan fills one flat hash table per key, so asking for more
+// breakdowns never costs another pass over the history.
+
+enum GroupKey { GROUP_DONOR, GROUP_RECIPIENT, GROUP_FOOD_TYPE, GROUP_YEAR, GROUP_MONTH };
+
+// Measures a report can show for each group. Every row tracks all of them;
+// the mask only selects what gets printed.
+enum GroupMeasure {
+    MEASURE_COUNT = 1,
+    MEASURE_KG = 2,
+    MEASURE_MONEY = 4,
+    MEASURE_MIN_MAX = 8,
+    MEASURE_ALL = 15
+};
+
+struct GroupRow {
+    DonationTally tally;
+    int minKg = 0, maxKg = 0;            // over food donations
+    long long minCents = 0, maxCents = 0;  // over money donations
+
+    void add(const Donation& d) {
+        if (d.isMoneyDonation()) {
+            long long cents = DonationTally::toCents(d.getMoneyAmount());
+            if (tally.moneyCount == 0 || cents < minCents) minCents = cents;
+            if (tally.moneyCount == 0 || cents > maxCents) maxCents = cents;
+        } else {
+            size_t foodCount = tally.count - tally.moneyCount;
+            if (foodCount == 0 || d.getQuantity() < minKg) minKg = d.getQuantity();
+            if (foodCount == 0 || d.getQuantity() > maxKg) maxKg = d.getQuantity();
+        }
+        tally.add(d);
+    }
+
+    void merge(const GroupRow& other) {
+        size_t foodCount = tally.count - tally.moneyCount;
+        size_t otherFood = other.tally.count - other.tally.moneyCount;
+        if (otherFood > 0) {
+            minKg = foodCount == 0 ? other.minKg : std::min(minKg, other.minKg);
+            maxKg = foodCount == 0 ? other.maxKg : std::max(maxKg, other.maxKg);
+        }
+        if (other.tally.moneyCount > 0) {
+            minCents = tally.moneyCount == 0 ? other.minCents : std::min(minCents, other.minCents);
+            maxCents = tally.moneyCount == 0 ? other.maxCents : std::max(maxCents, other.maxCents);
+        }
+        tally.merge(other.tally);
+    }
+};
+
+// Open-addressing hash table (linear probing, power-of-two capacity) from
+// a 64-bit group key to its row. Keys and rows sit in flat arrays.
+class FlatGroupTable {
+private:
+    std::vector<int64_t> keys;
+    std::vector<GroupRow> rows;
+    std::vector<uint8_t> used;
+    size_t count;
+
+    static size_t hash(int64_t key) {
+        uint64_t h = static_cast<uint64_t>(key) * 0x9E3779B97F4A7C15ull;
+        return static_cast<size_t>(h ^ (h >> 32));
+    }
+
+    void grow() {
+        std::vector<int64_t> oldKeys;
+        std::vector<GroupRow> oldRows;
+        std::vector<uint8_t> oldUsed;
+        oldKeys.swap(keys);
+        oldRows.swap(rows);
+        oldUsed.swap(used);
+        size_t capacity = oldKeys.empty() ? 16 : oldKeys.size() * 2;
+        keys.assign(capacity, 0);
+        rows.assign(capacity, GroupRow());
+        used.assign(capacity, 0);
+        count = 0;
+        for (size_t i = 0; i < oldKeys.size(); i++) {
+            if (oldUsed[i]) (*this)[oldKeys[i]] = oldRows[i];
+        }
+    }
+
+public:
+    FlatGroupTable() : count(0) {}
+
+    GroupRow& operator[](int64_t key) {
+        if ((count + 1) * 4 > keys.size() * 3) grow();
+        size_t mask = keys.size() - 1;
+        size_t slot = hash(key) & mask;
+        while (used[slot] && keys[slot] != key) slot = (slot + 1) & mask;
+        if (!used[slot]) {
+            used[slot] = 1;
+            keys[slot] = key;
+            count++;
+        }
+        return rows[slot];
+    }
+
+    const GroupRow* find(int64_t key) const {
+        if (keys.empty()) return nullptr;
+        size_t mask = keys.size() - 1;
+        for (size_t slot = hash(key) & mask; used[slot]; slot = (slot + 1) & mask) {
+            if (keys[slot] == key) return &rows[slot];
+        }
+        return nullptr;
+    }
+
+    size_t size() const { return count; }
+
+    template <typename F>
+    void forEach(F f) const {
+        for (size_t i = 0; i < keys.size(); i++) {
+            if (used[i]) f(keys[i], rows[i]);
+        }
+    }
+
+    // Keys in ascending order, for printing.
+    std::vector<int64_t> sortedKeys() const {
+        std::vector<int64_t> result;
+        result.reserve(count);
+        forEach([&result](int64_t key, const GroupRow&) { result.push_back(key); });
+        std::sort(result.begin(), result.end());
+        return result;
+    }
+
+    void merge(const FlatGroupTable& other) {
+        other.forEach([this](int64_t key, const GroupRow& row) { (*this)[key].merge(row); });
+    }
+};
+
+// The tables produced by one group-by pass, one per requested key, plus
+// the overall row.
+struct GroupByResult {
+    std::vector<GroupKey> keys;
+    std::vector<FlatGroupTable> tables;
+    GroupRow overall;
+
+    explicit GroupByResult(const std::vector<GroupKey>& k) : keys(k), tables(k.size()) {}
+
+    const FlatGroupTable& table(GroupKey key) const {
+        for (size_t i = 0; i < keys.size(); i++) {
+            if (keys[i] == key) return tables[i];
+        }
+        static const FlatGroupTable EMPTY_TABLE;
+        return EMPTY_TABLE;
+    }
+
+    void merge(const GroupByResult& other) {
+        overall.merge(other.overall);
+        for (size_t i = 0; i < tables.size(); i++) tables[i].merge(other.tables[i]);
+    }
+};
+
+// Group key of a donation. Returns false if the donation does not belong to
+// any group under this key (money donations have no food type).
+bool groupKeyOf(GroupKey key, const Donation& d, int64_t& out) {
+    switch (key) {
+        case GROUP_DONOR:     out = d.getDonorId(); return true;
+        case GROUP_RECIPIENT: out = d.getRecipientId(); return true;
+        case GROUP_FOOD_TYPE: out = d.getFoodTypeId(); return !d.isMoneyDonation();
+        case GROUP_YEAR: {
+            Date date = d.getDateValue();
+            out = date.isValid() ? date.year() : 0;
+            return true;
+        }
+        case GROUP_MONTH: {
+            Date date = d.getDateValue();
+            out = date.isValid() ? date.year() * 100 + date.month() : 0;  // YYYYMM
+            return true;
+        }
+    }
+    return false;
+}
+
+GroupByResult groupDonations(const std::vector<Donation>& donations, const std::vector<GroupKey>& keys,
+                             size_t begin, size_t end) {
+    GroupByResult result(keys);
+    int64_t k;
+    for (size_t i = begin; i < end; i++) {
+        const Donation& d = donations[i];
+        result.overall.add(d);
+        for (size_t t = 0; t < keys.size(); t++) {
+            if (groupKeyOf(keys[t], d, k)) result.tables[t][k].add(d);
+        }
+    }
+    return result;
+}
+
+#endif
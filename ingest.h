@@ -0,0 +1,146 @@
+#ifndef INGEST_H
+#define INGEST_H
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include "donor.h"
+#include "recipient.h"
+#include "donation.h"
+#include "reporting.h"
+
+// Bulk loader for a day's intake. Each line of the input is one donation:
+//   food,<donor name>,<recipient id>,<food type>,<kg>,<DD-MM-YYYY>
+//   money,<donor name>,<recipient id>,<amount>,<DD-MM-YYYY>
+// Fields are separated by commas or tabs. Blank lines, lines starting with
+// '#' and a "type,..." header row are skipped.
+
+struct IngestStats {
+    size_t lines = 0;
+    size_t accepted = 0;
+    size_t rejected = 0;
+};
+
+class DonationIngestor {
+private:
+    DonorManager& donorManager;
+    RecipientLinkedList& recipients;
+    Reporting& report;
+    Inventory& inventory;
+    std::vector<Donation> batch;
+    IngestStats stats;
+
+    static const size_t MAX_REPORTED_ERRORS = 20;
+
+    static std::vector<std::string> splitFields(const std::string& line) {
+        char delim = line.find('\t') != std::string::npos ? '\t' : ',';
+        std::vector<std::string> fields;
+        size_t start = 0;
+        while (true) {
+            size_t end = line.find(delim, start);
+            fields.push_back(line.substr(start, end - start));
+            if (end == std::string::npos) break;
+            start = end + 1;
+        }
+        return fields;
+    }
+
+    void reject(const std::string& reason) {
+        stats.rejected++;
+        if (stats.rejected <= MAX_REPORTED_ERRORS) {
+            std::cerr << "Line " << stats.lines << ": " << reason << "\n";
+        }
+    }
+
+    // Same checks as menu option 2: known donor, known recipient, positive
+    // amount and a DD-MM-YYYY date.
+    void parseLine(const std::string& line) {
+        std::vector<std::string> f = splitFields(line);
+        const std::string& type = f[0];
+        bool isMoney = (type == "money");
+        if (!isMoney && type != "food") {
+            reject("unknown donation type '" + type + "'");
+            return;
+        }
+        if (f.size() != (isMoney ? 5u : 6u)) {
+            reject("wrong number of fields");
+            return;
+        }
+
+        const Donor* donor = donorManager.find_donor_by_name(f[1]);
+        if (!donor) {
+            reject("donor '" + f[1] + "' not found");
+            return;
+        }
+
+        try {
+            int recipientId = std::stoi(f[2]);
+            if (!recipients.findRecipientById(recipientId)) {
+                reject("recipient " + f[2] + " not found");
+                return;
+            }
+            const std::string& date = f.back();
+            if (!isValidDate(date)) {
+                reject("invalid date '" + date + "'");
+                return;
+            }
+            if (isMoney) {
+                float amount = std::stof(f[3]);
+                if (amount <= 0) {
+                    reject("invalid amount");
+                    return;
+                }
+                batch.emplace_back(donor->get_id(), f[1], recipientId, amount, date);
+            } else {
+                int quantity = std::stoi(f[4]);
+                if (quantity <= 0) {
+                    reject("invalid quantity");
+                    return;
+                }
+                batch.emplace_back(donor->get_id(), f[1], recipientId, f[3], quantity, date);
+            }
+        } catch (const std::exception&) {
+            reject("malformed number or date");
+        }
+    }
+
+    void applyBatch() {
+        for (const auto& donation : batch) {
+            processDonation(donorManager, recipients, donation, &inventory, false);
+            report.addDonation(donation);
+        }
+        stats.accepted += batch.size();
+        batch.clear();
+    }
+
+public:
+    static const size_t BATCH_SIZE = 4096;
+
+    DonationIngestor(DonorManager& dm, RecipientLinkedList& r, Reporting& rep, Inventory& inv)
+        : donorManager(dm), recipients(r), report(rep), inventory(inv) {
+        batch.reserve(BATCH_SIZE);
+    }
+
+    // Validates and applies every record in the stream. Nothing is written to
+    // disk here; the caller persists the three data files once afterwards.
+    IngestStats run(std::istream& in) {
+        std::string line;
+        while (std::getline(in, line)) {
+            stats.lines++;
+            if (!line.empty() && line.back() == '\r') line.pop_back();
+            if (line.empty() || line[0] == '#') continue;
+            if (stats.lines == 1 && line.compare(0, 4, "type") == 0) continue;
+
+            parseLine(line);
+            if (batch.size() == BATCH_SIZE) applyBatch();
+        }
+        applyBatch();
+
+        if (stats.rejected > MAX_REPORTED_ERRORS) {
+            std::cerr << "... " << stats.rejected - MAX_REPORTED_ERRORS << " more rejected lines\n";
+        }
+        return stats;
+    }
+};
+
+#endif
@@ -0,0 +1,204 @@
+#ifndef INVENTORY_H
+#define INVENTORY_H
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <map>
+#include <set>
+#include <utility>
+#include <algorithm>
+#include <unordered_map>
+#include "date.h"
+#include "string_pool.h"
+#include "perf_stats.h"
+#include "persist.h"
+
+// Food stock on hand, per food type (StringPool id), as lots ordered by
+// expiry date. Lots of one type that expire on the same day are merged. A
+// second ordered index over (expiry, type) covers all types at once, so
+// taking the oldest stock and listing what expires in a window are both
+// O(log n) plus the lots touched.
+class Inventory {
+public:
+    struct Lot {
+        uint32_t foodType;
+        Date expiry;
+        long long kg;
+    };
+
+private:
+    std::unordered_map<uint32_t, std::map<int32_t, long long>> lotsByType;
+    std::set<std::pair<int32_t, uint32_t>> expiryIndex;
+    std::unordered_map<uint32_t, int> shelfLife;
+    long long totalKg;
+    const std::string dataFile = "inventory.dat";
+
+    static const int DEFAULT_SHELF_LIFE_DAYS = 14;
+
+    // Takes up to kg from one lot, dropping it once it is empty.
+    long long takeFromLot(uint32_t foodType, int32_t expiry, long long kg) {
+        std::map<int32_t, long long>& lots = lotsByType[foodType];
+        auto lot = lots.find(expiry);
+        long long taken = std::min(kg, lot->second);
+        lot->second -= taken;
+        totalKg -= taken;
+        if (lot->second == 0) {
+            lots.erase(lot);
+            expiryIndex.erase(std::make_pair(expiry, foodType));
+            if (lots.empty()) lotsByType.erase(foodType);
+        }
+        return taken;
+    }
+
+    void load() {
+        ScopedTimer timer(PERF_INVENTORY_LOAD);
+        GroupCommitter::instance().flush();
+        std::ifstream in(dataFile);
+        std::string line;
+        while (std::getline(in, line)) {
+            std::istringstream fields(line);
+            std::string kind, type, value;
+            std::getline(fields, kind, '\t');
+            std::getline(fields, type, '\t');
+            uint32_t foodType = StringPool::instance().intern(type);
+            if (kind == "shelf") {
+                int days;
+                if (fields >> days) shelfLife[foodType] = days;
+            } else if (kind == "lot") {
+                std::string expiry;
+                long long kg;
+                std::getline(fields, expiry, '\t');
+                Date date = Date::parse(expiry);
+                if (fields >> kg && date.isValid()) addLot(foodType, date, kg);
+            }
+        }
+    }
+
+public:
+    Inventory() : totalKg(0) { load(); }
+    ~Inventory() { save(); }
+
+    void save() const {
+        ScopedTimer timer(PERF_INVENTORY_SAVE);
+        std::ostringstream out;
+        const StringPool& pool = StringPool::instance();
+        for (const auto& entry : shelfLife) {
+            out << "shelf\t" << pool.get(entry.first) << "\t" << entry.second << "\n";
+        }
+        for (const auto& key : expiryIndex) {
+            out << "lot\t" << pool.get(key.second) << "\t" << Date(key.first).toString() << "\t"
+                << lotsByType.at(key.second).at(key.first) << "\n";
+        }
+        GroupCommitter::instance().replace(dataFile, out.str());
+    }
+
+    int getShelfLife(uint32_t foodType) const {
+        auto it = shelfLife.find(foodType);
+        return it == shelfLife.end() ? DEFAULT_SHELF_LIFE_DAYS : it->second;
+    }
+
+    void setShelfLife(uint32_t foodType, int days) { shelfLife[foodType] = days; }
+
+    void addLot(uint32_t foodType, Date expiry, long long kg) {
+        if (kg <= 0) return;
+        lotsByType[foodType][expiry.dayNumber()] += kg;
+        expiryIndex.insert(std::make_pair(expiry.dayNumber(), foodType));
+        totalKg += kg;
+    }
+
+    // A food donation received on a given day, kept for the type's shelf life.
+    void receive(uint32_t foodType, long long kg, Date donated) {
+        if (!donated.isValid()) donated = Date::today();
+        addLot(foodType, donated + getShelfLife(foodType), kg);
+    }
+
+    // Takes up to kg of one food type, soonest-expiring first. Returns the
+    // amount actually taken.
+    long long take(uint32_t foodType, long long kg) {
+        long long taken = 0;
+        while (taken < kg) {
+            auto type = lotsByType.find(foodType);
+            if (type == lotsByType.end()) break;
+            taken += takeFromLot(foodType, type->second.begin()->first, kg - taken);
+        }
+        return taken;
+    }
+
+    // Takes up to kg across all food types, soonest-expiring first.
+    long long takeOldest(long long kg) {
+        long long taken = 0;
+        while (taken < kg && !expiryIndex.empty()) {
+            std::pair<int32_t, uint32_t> oldest = *expiryIndex.begin();
+            taken += takeFromLot(oldest.second, oldest.first, kg - taken);
+        }
+        return taken;
+    }
+
+    // Lots expiring from..to inclusive, soonest first.
+    std::vector<Lot> expiringBetween(Date from, Date to) const {
+        std::vector<Lot> result;
+        for (auto it = expiryIndex.lower_bound(std::make_pair(from.dayNumber(), 0u));
+             it != expiryIndex.end() && it->first <= to.dayNumber(); ++it) {
+            Lot lot = {it->second, Date(it->first), lotsByType.at(it->second).at(it->first)};
+            result.push_back(lot);
+        }
+        return result;
+    }
+
+    // Drops every lot that expired before today. Returns the kg discarded.
+    long long discardExpired(Date today) {
+        long long discarded = 0;
+        while (!expiryIndex.empty() && expiryIndex.begin()->first < today.dayNumber()) {
+            std::pair<int32_t, uint32_t> oldest = *expiryIndex.begin();
+            discarded += takeFromLot(oldest.second, oldest.first, lotsByType[oldest.second][oldest.first]);
+        }
+        return discarded;
+    }
+
+    long long available(uint32_t foodType) const {
+        auto type = lotsByType.find(foodType);
+        if (type == lotsByType.end()) return 0;
+        long long kg = 0;
+        for (const auto& lot : type->second) kg += lot.second;
+        return kg;
+    }
+
+    long long total() const { return totalKg; }
+
+    void displayStock() const {
+        if (lotsByType.empty()) {
+            std::cout << "No stock on hand.\n";
+            return;
+        }
+        std::map<std::string, uint32_t> types;
+        for (const auto& entry : lotsByType) {
+            types[StringPool::instance().get(entry.first)] = entry.first;
+        }
+        std::cout << "\n=== Inventory ===\n"
+                  << "Food Type\tKg\tNext Expiry\n"
+                  << "--------------------------------\n";
+        for (const auto& type : types) {
+            const std::map<int32_t, long long>& lots = lotsByType.at(type.second);
+            std::cout << type.first << "\t\t" << available(type.second) << "\t"
+                      << Date(lots.begin()->first).toString() << "\n";
+        }
+        std::cout << "Total: " << totalKg << " kg\n"
+                  << "================================\n";
+    }
+
+    void displayExpiring(Date from, Date to) const {
+        std::vector<Lot> lots = expiringBetween(from, to);
+        std::cout << "\n=== Expiring " << from.toString() << " to " << to.toString() << " ===\n";
+        if (lots.empty()) std::cout << "Nothing expires in this period.\n";
+        for (const auto& lot : lots) {
+            std::cout << lot.expiry.toString() << "\t" << StringPool::instance().get(lot.foodType)
+                      << "\t" << lot.kg << " kg\n";
+        }
+        std::cout << "================================\n";
+    }
+};
+
+#endif
@@ -3,8 +3,15 @@
 #include "recipient.h"
 #include "donation.h"
 #include "reporting.h"
+#include "ingest.h"
+#include "distribution_scheduler.h"
+#include "export.h"
+#include "service.h"
 #include <random>
+#include <chrono>
 #include <limits> // For numeric_limits
+#include <cstdlib>
+#include <cstring>
 
 using namespace std;
 
@@ -22,22 +29,16 @@ void displayMenu() {
     cout << "10. Food Requests\n";
     cout << "11. Distributed Food\n";
     cout << "12. Clear All Recipients Data\n";
+    cout << "13. Monthly Audit\n";
+    cout << "14. Donations Between Dates\n";
+    cout << "15. Donation Breakdown\n";
+    cout << "16. Inventory\n";
+    cout << "17. Performance Stats\n";
+    cout << "18. Export Data\n";
     cout << "E. Exit\n";
     cout << "Choose an option: ";
 }
 
-bool isValidDate(const string& date) {
-    // Basic format check
-    if (date.length() != 10 || date[2] != '-' || date[5] != '-') 
-        return false;
-    
-    // Check day/month ranges
-    int day = stoi(date.substr(0,2));
-    int month = stoi(date.substr(3,2));
-    
-    return (day >= 1 && day <= 31) && (month >= 1 && month <= 12);
-}
-
 void displayAvailableDonors(const DonorManager& dm) {
     cout << "\nRegistered Donors:\n";
     for (const auto& donor : dm.getDonors()) {
@@ -64,17 +65,7 @@ int getValidatedInt(const string& prompt, int min, int max) {
     }
 }
 
-int main() {
-    std::random_device rd;
-    std::mt19937 gen(rd());
-    std::uniform_int_distribution<> dist(100, 999);
-    DonorManager donorManager;
-    RecipientLinkedList recipients; // Use RecipientLinkedList instead of vector<recipient>
-    recipients.setAutoSave(false);
-    Reporting report(donorManager, recipients);
-
-    recipients.loadFromFile();
-    report.cleanupOrphanedDonations(donorManager, recipients);
+void addDefaultRecipients(RecipientLinkedList& recipients) {
     const int DEFAULT_IDS[] = {101, 102};
     const string DEFAULT_NAMES[] = {"Food Bank", "Shelter"};
     
@@ -92,8 +83,169 @@ int main() {
             recipients.addRecipient(newRec);
         }
     }
+}
+
+// food_donation --ingest <file>: loads a file of donations without the menu.
+// All the data files are written once, by the destructors at the end of
+// the block, instead of once per record.
+int runIngest(const string& path, size_t reportThreads) {
+    ifstream in(path);
+    if (!in) {
+        cerr << "Cannot open " << path << endl;
+        return 1;
+    }
+
+    auto start = chrono::steady_clock::now();
+    IngestStats stats;
+    {
+        DonorManager donorManager;
+        RecipientLinkedList recipients;
+        recipients.setAutoSave(false);
+        Reporting report(donorManager, recipients, reportThreads);
+        Inventory inventory;
+        addDefaultRecipients(recipients);
+
+        DonationIngestor ingestor(donorManager, recipients, report, inventory);
+        stats = ingestor.run(in);
+    }
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    cout << "Ingested " << stats.accepted << " donations (" << stats.rejected << " rejected) in "
+         << fixed << setprecision(3) << seconds << " s";
+    if (seconds > 0) {
+        cout << ", " << setprecision(0) << stats.accepted / seconds << " records/s";
+    }
+    cout << endl;
+    return stats.rejected == 0 ? 0 : 2;
+}
+
+// Asks for a month, a quarter or a custom range. Returns false on bad input.
+bool readPeriod(Date& from, Date& to) {
+    int kind = getValidatedInt(
+        "Period:\n"
+        "1. Month\n"
+        "2. Quarter\n"
+        "3. Custom range\n"
+        "Choose option: ", 1, 3);
+    if (kind == 3) {
+        string first, last;
+        cout << "From (DD-MM-YYYY): ";
+        getline(cin, first);
+        cout << "To (DD-MM-YYYY): ";
+        getline(cin, last);
+        from = Date::parse(first);
+        to = Date::parse(last);
+        return from.isValid() && to.isValid();
+    }
+
+    int year = getValidatedInt("Year: ", 1900, 9999);
+    unsigned firstMonth, lastMonth;
+    if (kind == 1) {
+        firstMonth = lastMonth = getValidatedInt("Month (1-12): ", 1, 12);
+    } else {
+        int quarter = getValidatedInt("Quarter (1-4): ", 1, 4);
+        firstMonth = quarter * 3 - 2;
+        lastMonth = quarter * 3;
+    }
+    from = Date::fromCivil(year, firstMonth, 1);
+    to = Date::fromCivil(year, lastMonth, Date::daysInMonth(year, lastMonth));
+    return true;
+}
+
+// Writes donations, donors or recipients to path, as JSON if it ends in
+// .json and as CSV otherwise.
+bool exportData(const string& what, const string& path, Reporting& report,
+                const DonorManager& donorManager, const RecipientLinkedList& recipients) {
+    ExportFormat format = exportFormatFor(path);
+    size_t rows = 0;
+    bool ok;
+    if (what == "donations") {
+        ok = exportToFile(path, [&](ostream& out) { rows = exportDonations(out, format, report.getDonations()); });
+    } else if (what == "donors") {
+        ok = exportToFile(path, [&](ostream& out) { rows = exportDonors(out, format, donorManager.getDonors()); });
+    } else if (what == "recipients") {
+        ok = exportToFile(path, [&](ostream& out) { rows = exportRecipients(out, format, recipients); });
+    } else {
+        cerr << "Unknown data set " << what << "; use donations, donors or recipients" << endl;
+        return false;
+    }
+    if (!ok) {
+        cerr << "Cannot write " << path << ": " << strerror(errno) << endl;
+        return false;
+    }
+    cout << "Exported " << rows << " " << what << " to " << path << ".\n";
+    return true;
+}
+
+// food_donation --export <what> <file>: exports without the menu.
+int runExport(const string& what, const string& path, size_t reportThreads) {
+    DonorManager donorManager;
+    RecipientLinkedList recipients;
+    recipients.setAutoSave(false);
+    Reporting report(donorManager, recipients, reportThreads);
+    return exportData(what, path, report, donorManager, recipients) ? 0 : 1;
+}
+
+// Sends the command, or each line of stdin if there is none, to a running
+// service and prints the replies.
+int runClient(const string& path, const string& command) {
+    ServiceClient client;
+    if (!client.connect(path)) {
+        cerr << "Cannot connect to " << path << ": " << strerror(errno) << endl;
+        return 1;
+    }
+    bool failed = false;
+    if (!command.empty()) {
+        if (!client.send(command, failed)) {
+            cerr << "Connection lost" << endl;
+            return 1;
+        }
+        return failed ? 2 : 0;
+    }
+    string line;
+    while (getline(cin, line)) {
+        if (line.empty()) continue;
+        if (!client.send(line, failed)) {
+            cerr << "Connection lost" << endl;
+            return 1;
+        }
+    }
+    return failed ? 2 : 0;
+}
+
+// food_donation --range <from> <to>: prints the donations in a period and exits.
+int runRangeReport(const string& first, const string& last, size_t reportThreads) {
+    Date from = Date::parse(first), to = Date::parse(last);
+    if (!from.isValid() || !to.isValid()) {
+        cerr << "Dates must be DD-MM-YYYY" << endl;
+        return 1;
+    }
+    DonorManager donorManager;
+    RecipientLinkedList recipients;
+    recipients.setAutoSave(false);
+    Reporting report(donorManager, recipients, reportThreads);
+    report.generateDateRangeReport(from, to);
+    return 0;
+}
+
+// The interactive menu. Returns once the user exits and every manager has
+// saved its data.
+int runMenu(size_t reportThreads, const AutosaveSettings& autosave) {
+    std::random_device rd;
+    std::mt19937 gen(rd());
+    std::uniform_int_distribution<> dist(100, 999);
+    DonorManager donorManager;
+    RecipientLinkedList recipients; // Use RecipientLinkedList instead of vector<recipient>
+    recipients.setAutoSave(false);
+    Reporting report(donorManager, recipients, reportThreads);
+    Inventory inventory;
+
+    recipients.loadFromFile();
+    report.cleanupOrphanedDonations(donorManager, recipients);
+    addDefaultRecipients(recipients);
 
     recipients.setAutoSave(true);
+    if (autosave.interval.count() > 0) recipients.startBackgroundSave(autosave);
     
 
 
@@ -120,8 +272,23 @@ int main() {
                 getline(cin, name);
                 cout << "Enter donor contact details: ";
                 getline(cin, contact);
+                if (donorManager.find_donor_by_name(name)) {
+                    cout << "A donor named " << name << " is already registered.\n";
+                    break;
+                }
+                if (donorManager.getDonors().size() >= 900) {
+                    cout << "No donor IDs left to assign.\n";
+                    break;
+                }
                 int id = dist(gen);
-                donorManager.register_donor(name, contact, id);
+                while (donorManager.find_donor_by_id(id)) id = dist(gen);
+                if (!donorManager.register_donor(name, contact, id)) {
+                    cout << "Could not register " << name << ".\n";
+                    break;
+                }
+                // Saved now: after a crash, the startup orphan cleanup would
+                // otherwise remove this donor's journaled donations.
+                donorManager.saveDonors();
                 cout << "Your ID is " << id << endl;
                 cout << "Donor registered successfully!\n";
                 //recipients.addRecipient(recipient(name, id));  // This adds the donor as a recipient
@@ -159,17 +326,12 @@ int main() {
                 getline(cin, donorName);
                 if (donorName == "cancel") break;
 
-                int donorId = -1;
-for (const auto& donor : donorManager.getDonors()) {
-    if (donor.get_name() == donorName) {
-        donorId = donor.get_id();
-        break;
-    }
-}
-if (donorId == -1) {
-    cout << "Donor not found. Returning to menu.\n";
-    continue;
-}
+                const Donor* donor = donorManager.find_donor_by_name(donorName);
+                if (!donor) {
+                    cout << "Donor not found. Returning to menu.\n";
+                    continue;
+                }
+                int donorId = donor->get_id();
             
                 cout << "Enter recipient ID: ";
                 if (!(cin >> recipientId)) { // Check if input failed
@@ -199,20 +361,7 @@ if (donorId == -1) {
                     break;
                 }
             
-                // Validate donor and recipient
-                bool donorValid = false;
-                for (const auto& donor : donorManager.getDonors()) {
-                    if (donor.get_name() == donorName) {
-                        donorValid = true;
-                        break;
-                    }
-                }
-                
-                if (!donorValid) {
-                    cout << "Donor not found. Returning to menu.\n";
-                    break;
-                }
-            
+                // Validate recipient
                 if (!recipients.findRecipientById(recipientId)) {
                     cout << "Recipient not found. Returning to menu.\n";
                     break;
@@ -220,8 +369,11 @@ if (donorId == -1) {
             
                 // All validations passed - create donation
                 Donation donation(donorId, donorName, recipientId, foodType, quantity, date);
-        processDonation(donorManager, recipients, donation);
+        processDonation(donorManager, recipients, donation, &inventory);
         report.addDonation(donation);
+        report.forceSaveAll();
+        donorManager.saveDonors();
+        inventory.save();
                 cout << "\nDonation recorded successfully!\n";
                 break;
             } 
@@ -276,20 +428,12 @@ if (donorId == -1) {
                 }
             
                 // Verify donor exists
-                bool donorValid = false;
-                int donorId = -1;
-                for (const auto& donor : donorManager.getDonors()) {
-                    if (donor.get_name() == donorName) {
-                        donorValid = true;
-                        donorId = donor.get_id();
-                        break;
-                    }
-                }
-            
-                if (!donorValid) {
+                const Donor* donor = donorManager.find_donor_by_name(donorName);
+                if (!donor) {
                     cout << "Donor not found. Returning to menu.\n";
                     continue;
                 }
+                int donorId = donor->get_id();
             
                 if (!recipients.findRecipientById(recipientId)) {
                     cout << "Recipient not found. Returning to menu.\n";
@@ -299,6 +443,8 @@ if (donorId == -1) {
                 Donation moneyDonation(donorId, donorName, recipientId, amount, date);
                 processDonation(donorManager, recipients, moneyDonation);
                 report.addDonation(moneyDonation);
+                report.forceSaveAll();
+                donorManager.saveDonors();
                 cout << "\nMoney donation recorded successfully!\n";
                 break;
             }
@@ -312,21 +458,44 @@ if (donorId == -1) {
                     "Choose option: ", 1, 4);
                 
                 if (sortChoice == 4) break;
-                report.generateDonationReport(sortChoice - 1);  // Convert to 0-based index
+                int viewChoice = getValidatedInt(
+                    "1. Page by page\n"
+                    "2. Full report\n"
+                    "Choose option: ", 1, 2);
+                if (viewChoice == 2) {
+                    report.generateDonationReport(sortChoice - 1);  // Convert to 0-based index
+                    break;
+                }
+
+                DonationPager pager = report.pageDonations(static_cast<DonationOrder>(sortChoice - 1));
+                string command;
+                while (true) {
+                    report.printDonationPage(pager);
+                    if (pager.pageCount() <= 1) break;
+                    cout << (pager.hasPrev() ? "[p]revious  " : "") << (pager.hasNext() ? "[n]ext  " : "")
+                         << "[q]uit: ";
+                    if (!(cin >> command)) break;
+                    cin.ignore(numeric_limits<streamsize>::max(), '\n');
+                    if (command == "q") break;
+                    if (command == "n") pager.next();
+                    else if (command == "p") pager.prev();
+                }
                 break;
             }
             case 4: {
-                cout << "\n=== Distribution Report ===\n";
+                ScopedTimer timer(PERF_REPORT_DISTRIBUTION);
+                ReportWriter out;
+                out << "\n=== Distribution Report ===\n";
                 RecipientNode* current = recipients.getHead();
                 while (current) {
-                    current->rec.display();
-                    cout << "Money Received: $" << fixed << setprecision(2) 
-                         << current->rec.get_total_money() << "\n";
-                    cout << "Total Donations: " << current->rec.get_donation_count() << "\n";
-                    cout << "--------------------------\n";
+                    current->rec.display(out);
+                    out << "Money Received: $" << fixed << setprecision(2) 
+                        << current->rec.get_total_money() << "\n";
+                    out << "Total Donations: " << current->rec.get_donation_count() << "\n";
+                    out << "--------------------------\n";
                     current = current->next;
                 }
-                cout << "==========================\n";
+                out << "==========================\n";
                 break;
             }
             case 5:
@@ -336,6 +505,7 @@ if (donorId == -1) {
                 report.generateOverallSummary();
                 break;
                 case 7: {
+                    ScopedTimer timer(PERF_REPORT_DISTRIBUTION_SUMMARY);
                     float totalMoney = 0;
                     int totalDonations = 0;
                     RecipientNode* current = recipients.getHead();
@@ -345,12 +515,13 @@ if (donorId == -1) {
                         current = current->next;
                     }
                 
-                    cout << "\n=== Distribution Summary ===\n";
-                    cout << "Total Recipients: " << recipients.getSize() << endl;
-                    cout << "Total Food Distributed: " << recipients.getTotalDistributedFood() << " kg\n";
-                    cout << "Total Money Distributed: $" << fixed << setprecision(2) << totalMoney << "\n";
-                    cout << "Total Donations Received: " << totalDonations << "\n";
-                    cout << "===========================\n";
+                    ReportWriter out;
+                    out << "\n=== Distribution Summary ===\n";
+                    out << "Total Recipients: " << recipients.getSize() << "\n";
+                    out << "Total Food Distributed: " << recipients.getTotalDistributedFood() << " kg\n";
+                    out << "Total Money Distributed: $" << fixed << setprecision(2) << totalMoney << "\n";
+                    out << "Total Donations Received: " << totalDonations << "\n";
+                    out << "===========================\n";
                     break;
                 }
             case 8: 
@@ -365,14 +536,7 @@ if (donorId == -1) {
                     
                     if (donorManager.delete_donor(id)) {
                         // Remove associated donations
-                        auto& donations = report.getDonations(); // Add getDonations() to Reporting class
-                        donations.erase(
-                            remove_if(donations.begin(), donations.end(),
-                                [id](const Donation& d) {
-                                    return d.getDonorId() == id;
-                                }),
-                            donations.end()
-                        );
+                        report.removeDonationsByDonorId(id);
                         cout << "Donor and their donations deleted successfully.\n";
                     }
                     break;
@@ -382,12 +546,23 @@ if (donorId == -1) {
                     cout << "Enter recipient ID requesting food: ";
                     cin >> recipientId;
                     cout << "Enter quantity needed (kg): ";
-                    cin >> quantity;
+                    if (!(cin >> quantity) || quantity <= 0) {
+                        cin.clear();
+                        cin.ignore(numeric_limits<streamsize>::max(), '\n');
+                        cout << "Invalid quantity. Returning to menu.\n";
+                        break;
+                    }
                     cin.ignore();
+                    int urgency = getValidatedInt(
+                        "Urgency:\n"
+                        "1. Normal\n"
+                        "2. Urgent\n"
+                        "3. Critical\n"
+                        "Choose option: ", 1, 3);
                     
                     recipient* rec = recipients.findRecipientById(recipientId);
                     if (rec) {
-                        rec->request_food(quantity);
+                        rec->request_food(quantity, urgency - 1);
                         cout << "Food request added to queue." << endl;
                     } else {
                         cout << "Recipient not found!" << endl;
@@ -395,6 +570,39 @@ if (donorId == -1) {
                     break;
                 }
                 case 11: {
+                    int mode = getValidatedInt(
+                        "Distribute:\n"
+                        "1. Next request of one recipient\n"
+                        "2. Distribution day (all pending requests)\n"
+                        "Choose option: ", 1, 2);
+                    if (mode == 2) {
+                        int source = 2;
+                        if (inventory.total() > 0) {
+                            cout << "Stock source:\n"
+                                 << "1. Inventory (" << inventory.total() << " kg on hand, oldest first)\n"
+                                 << "2. Enter an amount\n";
+                            source = getValidatedInt("Choose option: ", 1, 2);
+                        }
+                        int stock = source == 1
+                            ? static_cast<int>(min<long long>(inventory.total(), numeric_limits<int>::max()))
+                            : getValidatedInt("Enter available stock (kg): ", 0, numeric_limits<int>::max());
+                        DistributionScheduler scheduler(recipients);
+                        DistributionSummary summary;
+                        {
+                            auto lock = recipients.lockForUpdate();
+                            summary = scheduler.run(stock);
+                        }
+                        summary.print();
+                        if (summary.stockAfter != summary.stockBefore) {
+                            if (source == 1) {
+                                inventory.takeOldest(summary.stockBefore - summary.stockAfter);
+                                inventory.save();
+                            }
+                            recipients.markDirty();
+                        }
+                        break;
+                    }
+
                     int recipientId;
                     cout << "Enter recipient ID to distribute food: ";
                     cin >> recipientId;
@@ -402,8 +610,13 @@ if (donorId == -1) {
                     
                     recipient* rec = recipients.findRecipientById(recipientId);
                     if (rec) {
-                        if (rec->distribute_food()) {
-                            recipients.forceSave();
+                        bool distributed;
+                        {
+                            auto lock = recipients.lockForUpdate();
+                            distributed = rec->distribute_food();
+                        }
+                        if (distributed) {
+                            recipients.markDirty();
                         }
                     } else {
                         cout << "Recipient not found!" << endl;
@@ -428,7 +641,105 @@ if (donorId == -1) {
                     }
                     break;
                 }
-            
+                case 13:
+                    report.generateAuditReport();
+                    break;
+                case 14: {
+                    Date from, to;
+                    if (!readPeriod(from, to)) {
+                        cout << "Invalid date format. Returning to menu.\n";
+                        break;
+                    }
+                    report.generateDateRangeReport(from, to);
+                    break;
+                }
+                case 15: {
+                    int key = getValidatedInt(
+                        "Group donations by:\n"
+                        "1. Donor\n"
+                        "2. Recipient\n"
+                        "3. Food type\n"
+                        "4. Year\n"
+                        "5. Month\n"
+                        "Choose option: ", 1, 5);
+                    int detail = getValidatedInt(
+                        "Show:\n"
+                        "1. Count, kg and money\n"
+                        "2. Count, kg, money and min/max\n"
+                        "Choose option: ", 1, 2);
+                    int measures = MEASURE_COUNT | MEASURE_KG | MEASURE_MONEY;
+                    if (detail == 2) measures |= MEASURE_MIN_MAX;
+                    report.generateBreakdownReport(static_cast<GroupKey>(key - 1), measures);
+                    break;
+                }
+                case 16: {
+                    int action = getValidatedInt(
+                        "Inventory:\n"
+                        "1. Stock by food type\n"
+                        "2. Expiring within 7 days\n"
+                        "3. Set shelf life of a food type\n"
+                        "4. Discard expired stock\n"
+                        "5. Back to Main Menu\n"
+                        "Choose option: ", 1, 5);
+                    Date today = Date::today();
+                    if (action == 1) {
+                        inventory.displayStock();
+                    } else if (action == 2) {
+                        inventory.displayExpiring(today, today + 7);
+                    } else if (action == 3) {
+                        string foodType;
+                        cout << "Enter food type: ";
+                        getline(cin, foodType);
+                        uint32_t typeId = StringPool::instance().intern(foodType);
+                        cout << "Current shelf life: " << inventory.getShelfLife(typeId) << " days\n";
+                        inventory.setShelfLife(typeId, getValidatedInt("New shelf life (days): ", 1, 3650));
+                        inventory.save();
+                        cout << "Applies to donations received from now on.\n";
+                    } else if (action == 4) {
+                        cout << "Discarded " << inventory.discardExpired(today) << " kg of expired stock.\n";
+                        inventory.save();
+                    }
+                    break;
+                }
+                case 17: {
+                    PerfStats& stats = PerfStats::instance();
+                    int action = getValidatedInt(
+                        string("Performance Stats:\n"
+                               "1. Show timings\n"
+                               "2. ") + (stats.isEnabled() ? "Stop" : "Start") + " recording\n"
+                        "3. Reset\n"
+                        "4. Back to Main Menu\n"
+                        "Choose option: ", 1, 4);
+                    if (action == 1) {
+                        ReportWriter out;
+                        stats.print(out);
+                    } else if (action == 2) {
+                        stats.setEnabled(!stats.isEnabled());
+                        cout << "Recording " << (stats.isEnabled() ? "started" : "stopped") << ".\n";
+                    } else if (action == 3) {
+                        stats.reset();
+                        cout << "Timings cleared.\n";
+                    }
+                    break;
+                }
+                case 18: {
+                    static const char* DATA_SETS[] = {"donations", "donors", "recipients"};
+                    int dataSet = getValidatedInt(
+                        "Export:\n"
+                        "1. Donations\n"
+                        "2. Donors\n"
+                        "3. Recipients\n"
+                        "4. Back\n"
+                        "Choose option: ", 1, 4);
+                    if (dataSet == 4) break;
+                    string path;
+                    cout << "File name (.csv or .json): ";
+                    getline(cin, path);
+                    if (path.empty()) path = string(DATA_SETS[dataSet - 1]) + ".csv";
+                    exportData(DATA_SETS[dataSet - 1], path, report, donorManager, recipients);
+                    break;
+                }
+
             default:
                 cout << "Invalid choice. Please try again.\n";
         }
@@ -441,4 +752,107 @@ if (donorId == -1) {
 //recipients.forceSave();
 //report.forceSaveAll();
 return 0;
-}
\ No newline at end of file
+}
+
+void printUsage(const char* program) {
+    cerr << "Usage: " << program << " [options]\n"
+         << "  --threads <n>                       worker threads for full-history report passes\n"
+         << "  --ingest <file>                     load donations from a CSV/TSV file and exit\n"
+         << "  --range <from> <to>                 print donations between two DD-MM-YYYY dates and exit\n"
+         << "  --export <data> <file>              write donations, donors or recipients to a .csv or .json file and exit\n"
+         << "  --serve <socket>                    answer client commands on a Unix socket until interrupted\n"
+         << "  --workers <n>                       clients served at once by --serve (default 8)\n"
+         << "  --client <socket> [command...]      send a command, or each line of stdin, to a running service\n"
+         << "  --convert-donations <text> <binary> convert a donations file to the binary format\n"
+         << "  --quiet                             print reports and prompts only\n"
+         << "  --verbose                           also print debug output when saving\n"
+         << "  --commit-window <ms>                coalesce saves within this many ms into one fsync (default 10)\n"
+         << "  --autosave-interval <ms>            save recipient changes in the background this often (default 1000;\n"
+         << "                                      0 saves on every change)\n"
+         << "  --autosave-changes <n>              or as soon as this many changes are pending (default 100)\n"
+         << "  --stats                             record operation timings and print them at exit\n";
+}
+
+int main(int argc, char* argv[]) {
+    size_t reportThreads = 1;
+    string ingestFile;
+    string rangeFrom, rangeTo;
+    string exportWhat, exportPath;
+    string servePath, clientPath, clientCommand;
+    size_t serviceWorkers = 8;
+    AutosaveSettings autosave;
+    bool printStats = false;
+    for (int i = 1; i < argc; i++) {
+        string option = argv[i];
+        if (option == "--threads" && i + 1 < argc) {
+            reportThreads = static_cast<size_t>(atoi(argv[++i]));
+        } else if (option == "--stats") {
+            printStats = true;
+        } else if (option == "--quiet") {
+            verbosity() = VERBOSITY_QUIET;
+        } else if (option == "--verbose") {
+            verbosity() = VERBOSITY_DEBUG;
+        } else if (option == "--commit-window" && i + 1 < argc) {
+            GroupCommitter::instance().setWindow(chrono::milliseconds(max(0, atoi(argv[++i]))));
+        } else if (option == "--ingest" && i + 1 < argc) {
+            ingestFile = argv[++i];
+        } else if (option == "--autosave-interval" && i + 1 < argc) {
+            autosave.interval = chrono::milliseconds(max(0, atoi(argv[++i])));
+        } else if (option == "--autosave-changes" && i + 1 < argc) {
+            autosave.changes = static_cast<size_t>(max(1, atoi(argv[++i])));
+        } else if (option == "--serve" && i + 1 < argc) {
+            servePath = argv[++i];
+        } else if (option == "--workers" && i + 1 < argc) {
+            serviceWorkers = static_cast<size_t>(max(1, atoi(argv[++i])));
+        } else if (option == "--client" && i + 1 < argc) {
+            clientPath = argv[++i];
+            // The rest of the arguments are the command.
+            while (i + 1 < argc) {
+                if (!clientCommand.empty()) clientCommand += ' ';
+                clientCommand += argv[++i];
+            }
+        } else if (option == "--export" && i + 2 < argc) {
+            exportWhat = argv[++i];
+            exportPath = argv[++i];
+        } else if (option == "--range" && i + 2 < argc) {
+            rangeFrom = argv[++i];
+            rangeTo = argv[++i];
+        } else if (option == "--convert-donations" && i + 2 < argc) {
+            if (!DonationStore::convert(argv[i + 1], argv[i + 2])) {
+                cerr << "Cannot convert " << argv[i + 1] << " to " << argv[i + 2] << endl;
+                return 1;
+            }
+            return 0;
+        } else {
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+    PerfStats::instance().setEnabled(printStats);
+
+    int status;
+    if (!ingestFile.empty()) {
+        status = runIngest(ingestFile, reportThreads);
+    } else if (!clientPath.empty()) {
+        status = runClient(clientPath, clientCommand);
+    } else if (!servePath.empty()) {
+        DonationService service(servePath, serviceWorkers, reportThreads, autosave);
+        status = service.run();
+    } else if (!exportWhat.empty()) {
+        status = runExport(exportWhat, exportPath, reportThreads);
+    } else if (!rangeFrom.empty()) {
+        status = runRangeReport(rangeFrom, rangeTo, reportThreads);
+    } else {
+        status = runMenu(reportThreads, autosave);
+    }
+
+    // Printed once the managers are gone, so the final saves are counted.
+    if (printStats) {
+        GroupCommitter& committer = GroupCommitter::instance();
+        committer.flush();
+        ReportWriter out;
+        PerfStats::instance().print(out);
+        out << committer.saveCount() << " saves written in " << committer.commitCount() << " group commits\n";
+    }
+    return status;
+}
@@ -0,0 +1,98 @@
+#ifndef MPSC_RING_H
+#define MPSC_RING_H
+
+#include <atomic>
+#include <memory>
+#include <new>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+// Bounded lock-free queue for many producers and one consumer. Each slot
+// carries a sequence number saying whose turn it is: a producer claims the
+// next slot with one compare-and-swap on the tail, fills it and publishes it
+// by bumping the sequence; the consumer reads slots in order without any
+// atomic read-modify-write. Neither side ever blocks the other, and a full
+// ring makes tryPush() fail rather than wait.
+template <typename T>
+class MpscRing {
+private:
+    struct Slot {
+        std::atomic<size_t> sequence;
+        typename std::aligned_storage<sizeof(T), alignof(T)>::type storage;
+
+        T* value() { return reinterpret_cast<T*>(&storage); }
+    };
+
+    static const size_t CACHE_LINE = 64;
+
+    std::unique_ptr<Slot[]> slots;
+    size_t mask;
+    char pad0[CACHE_LINE];
+    std::atomic<size_t> tail;   // next slot to claim, shared by producers
+    char pad1[CACHE_LINE];
+    size_t head;                // next slot to read, consumer only
+    char pad2[CACHE_LINE];
+
+    static size_t roundUp(size_t n) {
+        size_t capacity = 2;
+        while (capacity < n) capacity <<= 1;
+        return capacity;
+    }
+
+public:
+    // Capacity is rounded up to a power of two.
+    explicit MpscRing(size_t capacity)
+        : slots(new Slot[roundUp(capacity)]), mask(roundUp(capacity) - 1), tail(0), head(0) {
+        for (size_t i = 0; i <= mask; i++) slots[i].sequence.store(i, std::memory_order_relaxed);
+    }
+
+    ~MpscRing() {
+        while (true) {
+            Slot& slot = slots[head & mask];
+            if (slot.sequence.load(std::memory_order_acquire) != head + 1) break;
+            slot.value()->~T();
+            head++;
+        }
+    }
+
+    MpscRing(const MpscRing&) = delete;
+    MpscRing& operator=(const MpscRing&) = delete;
+
+    size_t capacity() const { return mask + 1; }
+
+    // Any thread. Returns false if the ring is full.
+    bool tryPush(const T& value) {
+        size_t pos = tail.load(std::memory_order_relaxed);
+        Slot* slot;
+        while (true) {
+            slot = &slots[pos & mask];
+            size_t sequence = slot->sequence.load(std::memory_order_acquire);
+            intptr_t lag = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos);
+            if (lag == 0) {
+                if (tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+            } else if (lag < 0) {
+                return false;  // the consumer has not freed this slot yet
+            } else {
+                pos = tail.load(std::memory_order_relaxed);
+            }
+        }
+        new (slot->value()) T(value);
+        slot->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer thread only. Returns false if the ring is empty.
+    bool tryPop(T& out) {
+        Slot& slot = slots[head & mask];
+        if (slot.sequence.load(std::memory_order_acquire) != head + 1) return false;
+        T* value = slot.value();
+        out = std::move(*value);
+        value->~T();
+        slot.sequence.store(head + mask + 1, std::memory_order_release);
+        head++;
+        return true;
+    }
+};
+
+#endif
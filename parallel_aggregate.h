@@ -0,0 +1,50 @@
+#ifndef PARALLEL_AGGREGATE_H
+#define PARALLEL_AGGREGATE_H
+
+#include <vector>
+#include <memory>
+#include <future>
+#include "donation.h"
+#include "group_by.h"
+#include "thread_pool.h"
+
+// Runs a group-by query with the donations split into one contiguous shard
+// per worker, then merges the per-shard tables. Every measure is an
+// integer (kg, cents, counts, min/max), so the merged result is identical
+// to a serial pass regardless of the number of shards.
+class ParallelAggregator {
+private:
+    std::unique_ptr<ThreadPool> pool;
+
+public:
+    // Below this many records a single pass beats the cost of fanning out.
+    static const size_t MIN_PARALLEL_RECORDS = 50000;
+
+    explicit ParallelAggregator(size_t threads = 1) { setThreads(threads); }
+
+    void setThreads(size_t threads) {
+        pool.reset(threads > 1 ? new ThreadPool(threads) : nullptr);
+    }
+
+    size_t threads() const { return pool ? pool->size() : 1; }
+
+    GroupByResult run(const std::vector<Donation>& donations, const std::vector<GroupKey>& keys) const {
+        size_t n = donations.size();
+        if (!pool || n < MIN_PARALLEL_RECORDS) return groupDonations(donations, keys, 0, n);
+
+        size_t shards = pool->size();
+        std::vector<std::future<GroupByResult>> partials;
+        for (size_t s = 0; s < shards; s++) {
+            size_t begin = n * s / shards, end = n * (s + 1) / shards;
+            partials.push_back(pool->submit([&donations, &keys, begin, end] {
+                return groupDonations(donations, keys, begin, end);
+            }));
+        }
+
+        GroupByResult result = partials[0].get();
+        for (size_t s = 1; s < shards; s++) result.merge(partials[s].get());
+        return result;
+    }
+};
+
+#endif
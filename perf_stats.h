@@ -0,0 +1,186 @@
+#ifndef PERF_STATS_H
+#define PERF_STATS_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include "report_writer.h"
+
+// Operations timed by ScopedTimer.
+enum PerfOp {
+    PERF_DONORS_LOAD,
+    PERF_DONORS_SAVE,
+    PERF_RECIPIENTS_LOAD,
+    PERF_RECIPIENTS_SAVE,
+    PERF_DONATIONS_LOAD,
+    PERF_DONATIONS_SAVE,
+    PERF_DONATIONS_COMPACT,
+    PERF_REQUESTS_LOAD,
+    PERF_INVENTORY_LOAD,
+    PERF_INVENTORY_SAVE,
+    PERF_PROCESS_DONATION,
+    PERF_FIND_RECIPIENT,
+    PERF_REPORT_DONATIONS,
+    PERF_REPORT_DONATION_PAGE,
+    PERF_REPORT_DISTRIBUTION,
+    PERF_REPORT_DONORS,
+    PERF_REPORT_OVERALL_SUMMARY,
+    PERF_REPORT_DISTRIBUTION_SUMMARY,
+    PERF_REPORT_DATE_RANGE,
+    PERF_REPORT_AUDIT,
+    PERF_REPORT_BREAKDOWN,
+    PERF_RANK_FREQUENCY,
+    PERF_RANK_KG,
+    PERF_RANK_MONEY,
+    PERF_CLEANUP_ORPHANS,
+    PERF_GROUP_COMMIT,
+    PERF_OP_COUNT
+};
+
+// Call counts and latency histograms per operation. Recording is off until
+// enabled; a disabled timer costs one relaxed atomic load. Counters are
+// atomic, so timers may run on any thread.
+//
+// Bucket 0 holds calls under 1 us and bucket i holds [4^(i-1), 4^i) us, so
+// the buckets run <1us, <4us, ... <1s; the last one holds everything slower.
+class PerfStats {
+public:
+    static const int BUCKETS = 12;
+
+private:
+    struct OpStats {
+        std::atomic<uint64_t> count;
+        std::atomic<uint64_t> totalNs;
+        std::atomic<uint64_t> maxNs;
+        std::atomic<uint64_t> buckets[BUCKETS];
+    };
+
+    OpStats ops[PERF_OP_COUNT];
+    std::atomic<bool> enabled;
+
+    PerfStats() : enabled(false) { reset(); }
+
+    static int bucketOf(uint64_t ns) {
+        uint64_t us = ns / 1000;
+        int bucket = 0;
+        while (us > 0 && bucket < BUCKETS - 1) {
+            us >>= 2;
+            bucket++;
+        }
+        return bucket;
+    }
+
+    static const char* bucketLabel(int bucket) {
+        static const char* LABELS[BUCKETS] = {
+            "<1us", "<4us", "<16us", "<64us", "<256us", "<1ms",
+            "<4ms", "<16ms", "<65ms", "<262ms", "<1s", ">=1s"
+        };
+        return LABELS[bucket];
+    }
+
+    static const char* name(int op) {
+        static const char* NAMES[PERF_OP_COUNT] = {
+            "donors load", "donors save", "recipients load", "recipients save",
+            "donations load", "donations save", "donations compact", "requests load",
+            "inventory load", "inventory save", "processDonation", "findRecipientById",
+            "donation report", "donation report page", "distribution report", "donor report", "overall summary",
+            "distribution summary", "date range report", "audit report", "breakdown report",
+            "rank by frequency", "rank by kg", "rank by money", "orphan cleanup",
+            "group commit"
+        };
+        return NAMES[op];
+    }
+
+    // Smallest bucket below which at least the given fraction of calls fell.
+    static int percentileBucket(const OpStats& s, double fraction) {
+        uint64_t target = static_cast<uint64_t>(fraction * s.count.load() + 0.5);
+        uint64_t seen = 0;
+        for (int b = 0; b < BUCKETS; b++) {
+            seen += s.buckets[b].load(std::memory_order_relaxed);
+            if (seen >= target && seen > 0) return b;
+        }
+        return BUCKETS - 1;
+    }
+
+public:
+    static PerfStats& instance() {
+        static PerfStats stats;
+        return stats;
+    }
+
+    bool isEnabled() const { return enabled.load(std::memory_order_relaxed); }
+    void setEnabled(bool on) { enabled.store(on, std::memory_order_relaxed); }
+
+    void reset() {
+        for (auto& s : ops) {
+            s.count = 0;
+            s.totalNs = 0;
+            s.maxNs = 0;
+            for (auto& b : s.buckets) b = 0;
+        }
+    }
+
+    void record(PerfOp op, uint64_t ns) {
+        OpStats& s = ops[op];
+        s.count.fetch_add(1, std::memory_order_relaxed);
+        s.totalNs.fetch_add(ns, std::memory_order_relaxed);
+        s.buckets[bucketOf(ns)].fetch_add(1, std::memory_order_relaxed);
+        uint64_t max = s.maxNs.load(std::memory_order_relaxed);
+        while (ns > max && !s.maxNs.compare_exchange_weak(max, ns, std::memory_order_relaxed)) {}
+    }
+
+    void print(std::ostream& out) const {
+        out << "\n=== Performance Stats ===\n";
+        if (!isEnabled()) out << "(recording is off)\n";
+        out << std::left << std::setw(24) << "Operation" << std::right
+            << "\tCalls\tTotal ms\tMean us\tMax us\tp50\tp99\n"
+            << "------------------------------------------------------------------------\n";
+        bool any = false;
+        for (int op = 0; op < PERF_OP_COUNT; op++) {
+            const OpStats& s = ops[op];
+            uint64_t count = s.count.load(std::memory_order_relaxed);
+            if (count == 0) continue;
+            any = true;
+            double totalUs = s.totalNs.load(std::memory_order_relaxed) / 1000.0;
+            out << std::left << std::setw(24) << name(op) << std::right << "\t" << count << "\t"
+                << std::fixed << std::setprecision(3) << totalUs / 1000.0 << "\t"
+                << std::setprecision(1) << totalUs / count << "\t"
+                << s.maxNs.load(std::memory_order_relaxed) / 1000.0 << "\t"
+                << bucketLabel(percentileBucket(s, 0.5)) << "\t"
+                << bucketLabel(percentileBucket(s, 0.99)) << "\n   ";
+            for (int b = 0; b < BUCKETS; b++) {
+                uint64_t n = s.buckets[b].load(std::memory_order_relaxed);
+                if (n > 0) out << " " << bucketLabel(b) << ":" << n;
+            }
+            out << "\n";
+        }
+        if (!any) out << "No operations recorded.\n";
+        out << "========================================================================\n";
+    }
+};
+
+// Times the enclosing scope into PerfStats when recording is enabled.
+class ScopedTimer {
+private:
+    PerfOp op;
+    bool active;
+    std::chrono::steady_clock::time_point start;
+
+public:
+    explicit ScopedTimer(PerfOp o) : op(o), active(PerfStats::instance().isEnabled()) {
+        if (active) start = std::chrono::steady_clock::now();
+    }
+
+    ~ScopedTimer() {
+        if (!active) return;
+        auto elapsed = std::chrono::steady_clock::now() - start;
+        PerfStats::instance().record(op, static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()));
+    }
+
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+};
+
+#endif
@@ -0,0 +1,212 @@
+#ifndef PERSIST_H
+#define PERSIST_H
+
+#include <string>
+#include <map>
+#include <set>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <iostream>
+#include <cstdio>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include "perf_stats.h"
+
+// Crash-safe file writes. A file that is replaced is written to <path>.tmp,
+// synced, and renamed over the original, so a crash leaves either the old or
+// the new contents and never a half-written file. Appends are synced in
+// place.
+
+bool writeAllTo(int fd, const char* data, size_t size) {
+    while (size > 0) {
+        ssize_t written = ::write(fd, data, size);
+        if (written < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        data += written;
+        size -= static_cast<size_t>(written);
+    }
+    return true;
+}
+
+std::string directoryOf(const std::string& path) {
+    size_t slash = path.rfind('/');
+    return slash == std::string::npos ? "." : path.substr(0, slash == 0 ? 1 : slash);
+}
+
+// Flushes a file written by other means to disk.
+bool syncFile(const std::string& path) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+    bool ok = ::fsync(fd) == 0;
+    ::close(fd);
+    return ok;
+}
+
+// Makes completed renames in a directory durable.
+bool syncDirectory(const std::string& dir) { return syncFile(dir); }
+
+// Writes contents to path.tmp, fsyncs it and renames it over path. The
+// directory is not synced; callers renaming several files sync it once.
+bool replaceFile(const std::string& path, const std::string& contents) {
+    std::string tmp = path + ".tmp";
+    int fd = ::open(tmp.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) return false;
+    bool ok = writeAllTo(fd, contents.data(), contents.size()) && ::fsync(fd) == 0;
+    ok = ::close(fd) == 0 && ok;
+    if (!ok || std::rename(tmp.c_str(), path.c_str()) != 0) {
+        std::remove(tmp.c_str());
+        return false;
+    }
+    return true;
+}
+
+bool appendToFile(const std::string& path, const std::string& contents) {
+    int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644);
+    if (fd < 0) return false;
+    bool ok = writeAllTo(fd, contents.data(), contents.size()) && ::fdatasync(fd) == 0;
+    return ::close(fd) == 0 && ok;
+}
+
+// Background group commit. Callers hand over the serialized contents of a
+// file and return at once; a committer thread writes them out after a short
+// window. Every save of a file within one window is folded into a single
+// write and a single fsync: a newer replacement supersedes the pending one,
+// and appends are concatenated. With a window of zero each save is
+// committed as soon as the thread picks it up.
+//
+// Anything that reads a committed file must call flush() first.
+class GroupCommitter {
+private:
+    struct PendingWrite {
+        bool replace = false;   // contents is the whole file
+        std::string contents;   // the new file, or the bytes to append
+    };
+
+    std::map<std::string, PendingWrite> pending;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable committed;
+    std::chrono::milliseconds window;
+    std::chrono::steady_clock::time_point deadline;
+    bool committing;
+    bool flushRequested;
+    bool stopping;
+    size_t saves;
+    size_t groups;
+    std::thread worker;
+
+    GroupCommitter()
+        : window(10), committing(false), flushRequested(false), stopping(false), saves(0), groups(0) {
+        PerfStats::instance();  // must outlive this object for the final commit
+        worker = std::thread(&GroupCommitter::run, this);
+    }
+
+    void submit(const std::string& path, std::string contents, bool replace) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (pending.empty()) deadline = std::chrono::steady_clock::now() + window;
+        PendingWrite& write = pending[path];
+        if (replace) {
+            write.replace = true;
+            write.contents = std::move(contents);
+        } else {
+            write.contents += contents;
+        }
+        saves++;
+        wake.notify_one();
+    }
+
+    // Replacements are written and their directories synced before any
+    // append, so a journal record never reaches the disk ahead of a file
+    // saved with it, such as the donor it refers to.
+    void commit(std::map<std::string, PendingWrite>& batch) {
+        ScopedTimer timer(PERF_GROUP_COMMIT);
+        std::set<std::string> renamedIn;
+        for (auto& entry : batch) {
+            if (!entry.second.replace) continue;
+            if (replaceFile(entry.first, entry.second.contents)) renamedIn.insert(directoryOf(entry.first));
+            else std::cerr << "Cannot save " << entry.first << ": " << std::strerror(errno) << std::endl;
+        }
+        for (const auto& dir : renamedIn) syncDirectory(dir);
+        for (auto& entry : batch) {
+            if (entry.second.replace || appendToFile(entry.first, entry.second.contents)) continue;
+            std::cerr << "Cannot save " << entry.first << ": " << std::strerror(errno) << std::endl;
+        }
+    }
+
+    void run() {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true) {
+            wake.wait(lock, [this] { return stopping || !pending.empty(); });
+            if (pending.empty()) break;  // stopping with nothing left
+            wake.wait_until(lock, deadline, [this] { return stopping || flushRequested; });
+
+            std::map<std::string, PendingWrite> batch;
+            batch.swap(pending);
+            committing = true;
+            lock.unlock();
+            commit(batch);
+            lock.lock();
+            committing = false;
+            groups++;
+            if (pending.empty()) flushRequested = false;
+            committed.notify_all();
+        }
+    }
+
+public:
+    static GroupCommitter& instance() {
+        static GroupCommitter committer;
+        return committer;
+    }
+
+    ~GroupCommitter() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wake.notify_one();
+        worker.join();
+    }
+
+    GroupCommitter(const GroupCommitter&) = delete;
+    GroupCommitter& operator=(const GroupCommitter&) = delete;
+
+    void setWindow(std::chrono::milliseconds ms) {
+        std::lock_guard<std::mutex> lock(mutex);
+        window = ms;
+    }
+
+    // Schedules path to be replaced by contents.
+    void replace(const std::string& path, std::string contents) { submit(path, std::move(contents), true); }
+
+    // Schedules contents to be appended to path.
+    void append(const std::string& path, std::string contents) { submit(path, std::move(contents), false); }
+
+    // Commits everything submitted so far and waits until it is on disk.
+    void flush() {
+        std::unique_lock<std::mutex> lock(mutex);
+        if (pending.empty() && !committing) return;
+        flushRequested = true;
+        wake.notify_one();
+        committed.wait(lock, [this] { return pending.empty() && !committing; });
+    }
+
+    // Saves submitted and group commits written, for the stats screen.
+    size_t saveCount() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return saves;
+    }
+
+    size_t commitCount() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return groups;
+    }
+};
+
+#endif
@@ -4,32 +4,51 @@
 #include <iostream>
 #include <string>
 #include <fstream>
+#include <sstream>
 #include <vector>
 #include <iomanip>
 #include <unordered_map>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
 #include "Queue.h"
+#include "request_store.h"
+#include "report_writer.h"
+#include "perf_stats.h"
+#include "persist.h"
 
 using namespace std;
 
 class RecipientNode;
 
+// When the background saver writes recipients.dat: after interval has
+// passed with changes pending, or as soon as changes reach the limit.
+struct AutosaveSettings {
+    std::chrono::milliseconds interval = std::chrono::milliseconds(1000);
+    size_t changes = 100;
+};
+
 class recipient {
 private:
     string name;
     int id;
     float totalKgReceived;
     int donationCount;
-    Queue foodRequestQueue;
+    Queue foodRequestQueue;       // used until the recipient joins a list
+    RequestStore* requestStore;   // set by the list; holds the persisted queue
     float totalMoneyReceived;
 
+    Queue& queue() { return requestStore ? requestStore->queue(id) : foodRequestQueue; }
+
 public:
     recipient(std::string n, int i) : name(n), id(i), totalKgReceived(0), 
-                                     donationCount(0), totalMoneyReceived(0) {}
+                                     donationCount(0), requestStore(nullptr), totalMoneyReceived(0) {}
 
                                      float get_total_money() const { return totalMoneyReceived; }
     void add_money(float amount) { totalMoneyReceived += amount; }
 
-    std::string get_name() const {
+    const std::string& get_name() const {
         return name;
     }
 
@@ -45,6 +64,54 @@ public:
 
     void set_donation_count(int count) { donationCount = count; }
 
+    // Food handed out against a request; unlike += it is not a donation.
+    void receive_food(float kg) { totalKgReceived += kg; }
+
+    // Moves any requests made so far into the store; from then on every
+    // change to the queue is journaled.
+    void attach_request_store(RequestStore* store) {
+        NODE request;
+        for (int level = NORMAL; level <= CRITICAL; level++) {
+            while (foodRequestQueue.dequeue(level, request)) {
+                store->enqueue(id, request.get_quantity(), level);
+            }
+        }
+        requestStore = store;
+    }
+
+    const Queue& requests() {
+        return queue();
+    }
+
+    // Pending request counts, answered without loading the queue.
+    int pending_requests() const {
+        return requestStore ? requestStore->pending(id) : foodRequestQueue.getSize();
+    }
+
+    int pending_requests(int urgency) const {
+        return requestStore ? requestStore->pending(id, urgency) : foodRequestQueue.getSize(urgency);
+    }
+
+    // Oldest request at one urgency level, or nullptr.
+    const NODE* front_request(int urgency) {
+        return queue().front(urgency);
+    }
+
+    // Sets the quantity still owed on the oldest request at one level.
+    void reduce_request(int urgency, int quantity) {
+        if (requestStore) {
+            requestStore->reduceFront(id, urgency, quantity);
+        } else if (NODE* front = foodRequestQueue.front(urgency)) {
+            front->set_quantity(quantity);
+        }
+    }
+
+    // Removes the oldest request at one level. Returns false if there is none.
+    bool complete_request(int urgency, NODE& request) {
+        if (requestStore) return requestStore->dequeue(id, urgency, request);
+        return foodRequestQueue.dequeue(urgency, request);
+    }
+
     recipient& operator+=(float food) {
         totalKgReceived += food;
         donationCount++;
@@ -55,8 +122,8 @@ public:
         return id == check_id;
     }
 
-    void display() const {
-        cout << "ID: " << id << "\n"
+    void display(ostream& out = cout) const {
+        out << "ID: " << id << "\n"
              << "Name: " << name << "\n"
              << "Total kg received: " << fixed << setprecision(2) << totalKgReceived << "\n"
              << "Total money received: $" << fixed << setprecision(2) << totalMoneyReceived << "\n"
@@ -64,27 +131,36 @@ public:
              << "--------------------------------\n";
     }
 
-    void request_food(int quantity) {
-        foodRequestQueue.enqueue(id, quantity);
+    void request_food(int quantity, int urgency = NORMAL) {
+        if (requestStore) {
+            requestStore->enqueue(id, quantity, urgency);
+            requestStore->flush();
+        } else {
+            foodRequestQueue.enqueue(id, quantity, urgency);
+        }
         cout << "Food request pending..." << endl;
     }
 
     bool distribute_food() {
-        if (foodRequestQueue.getSize() > 0) {  // Changed from get_size
-            NodePtr node = foodRequestQueue.dequeue();  // Changed from dequeue2
-            float quantity = node->get_value();
+        NODE request;
+        bool found = false;
+        for (int level = CRITICAL; level >= NORMAL && !found; level--) {
+            found = complete_request(level, request);
+        }
+        if (requestStore) requestStore->flush();
+        if (found) {
+            float quantity = request.get_value();
             totalKgReceived += quantity;
             cout << "✅ Distributed " << quantity << " kg to " << name << "\n";
-            delete node;
             return true;
         }
         cout << "⚠️  No pending requests for " << name << "\n";
         return false;
     }
     
-    void display_requests() const {
-        cout << "Pending requests: " << foodRequestQueue.getSize() << endl;  // Changed from get_size
-        foodRequestQueue.displayRequests();
+    void display_requests() {
+        cout << "Pending requests: " << pending_requests() << endl;  // Changed from get_size
+        queue().displayRequests();
     }
 
     static void sort_id(std::vector<recipient>& recipients) {
@@ -110,56 +186,82 @@ class RecipientNode {
     };
     
 
+    // Recipients are stored contiguously in a vector, with recipientMap
+    // giving the slot of each id. The next pointers are kept so callers can
+    // still walk the list from getHead(); they are relinked whenever the
+    // vector reallocates.
     class RecipientLinkedList {
         private:
-            RecipientNode* head;
-            RecipientNode* tail;
-            int size;
+            std::vector<RecipientNode> nodes;
             const string SAVE_FILE = "recipients.dat";
+            RequestStore requestStore;
             bool autoSave;
-            std::unordered_map<int, RecipientNode*> recipientMap;
+            std::unordered_map<int, size_t> recipientMap;
+
+            // Background saving. listMutex guards the recipients against the
+            // saver; it is recursive so that list methods may nest.
+            std::recursive_mutex listMutex;
+            std::mutex saverMutex;
+            std::condition_variable saverWake;
+            std::thread saver;
+            AutosaveSettings autosave;
+            size_t dirtyCount;
+            bool saverStopping;
+
+            void saverLoop() {
+                std::unique_lock<std::mutex> lock(saverMutex);
+                while (!saverStopping) {
+                    saverWake.wait_for(lock, autosave.interval,
+                        [this] { return saverStopping || dirtyCount >= autosave.changes; });
+                    if (dirtyCount == 0) continue;
+                    dirtyCount = 0;
+                    lock.unlock();
+                    {
+                        std::lock_guard<std::recursive_mutex> list(listMutex);
+                        saveToFile();
+                        requestStore.flush();
+                    }
+                    lock.lock();
+                }
+            }
+
+            void relink() {
+                for (size_t i = 0; i + 1 < nodes.size(); i++) {
+                    nodes[i].next = &nodes[i + 1];
+                }
+                if (!nodes.empty()) nodes.back().next = nullptr;
+            }
 
             void rebuildMap() {
                 recipientMap.clear();
-                RecipientNode* current = head;
-                while (current) {
-                    recipientMap[current->rec.get_id()] = current;
-                    current = current->next;
+                for (size_t i = 0; i < nodes.size(); i++) {
+                    recipientMap[nodes[i].rec.get_id()] = i;
                 }
             }
     
             void clear() {
-                while (head) {
-                    RecipientNode* temp = head;
-                    head = head->next;
-                    delete temp;
-                }
-                head = tail = nullptr;
-                size = 0;
+                nodes.clear();
                 recipientMap.clear();
             }
         
             void saveToFile() {
-                ofstream file(SAVE_FILE);
-                if (!file) {
-                    throw runtime_error("Cannot open file for writing");
-                }
-        
-                RecipientNode* current = head;
-                while (current) {
-                    file << current->rec.get_id() << "\n"
-                    << current->rec.get_name() << "\n"
-                    << current->rec.get_total_kg() << "\n"
-                    << current->rec.get_donation_count() << "\n"
-                    << current->rec.get_total_money() << "\n";
-                    current = current->next;
+                ScopedTimer timer(PERF_RECIPIENTS_SAVE);
+                ostringstream file;
+                for (const auto& node : nodes) {
+                    file << node.rec.get_id() << "\n"
+                    << node.rec.get_name() << "\n"
+                    << node.rec.get_total_kg() << "\n"
+                    << node.rec.get_donation_count() << "\n"
+                    << node.rec.get_total_money() << "\n";
                 }
+                GroupCommitter::instance().replace(SAVE_FILE, file.str());
             }
 
         
 
     public:
-    RecipientLinkedList() : head(nullptr), tail(nullptr), size(0), autoSave(true) {
+    RecipientLinkedList()
+        : requestStore("requests.dat", "requests.journal"), autoSave(true), dirtyCount(0), saverStopping(false) {
         loadFromFile();
     }
 
@@ -167,18 +269,65 @@ class RecipientNode {
     
     
     ~RecipientLinkedList() {
+        stopBackgroundSave();
         forceSave(); // Use forceSave instead of direct saveToFile
         clear();
     }
 
-    
+    // From now on markDirty() only counts changes, and a worker thread
+    // saves them as the settings say. Changes still pending are saved by
+    // stopBackgroundSave() and by the destructor.
+    void startBackgroundSave(const AutosaveSettings& settings) {
+        if (saver.joinable()) return;
+        autosave = settings;
+        saverStopping = false;
+        saver = std::thread(&RecipientLinkedList::saverLoop, this);
+    }
+
+    void stopBackgroundSave() {
+        if (!saver.joinable()) return;
+        {
+            std::lock_guard<std::mutex> lock(saverMutex);
+            saverStopping = true;
+        }
+        saverWake.notify_one();
+        saver.join();
+        if (dirtyCount > 0) {
+            dirtyCount = 0;
+            forceSave();
+        }
+    }
+
+    // Holds the background saver off while the caller changes recipients
+    // through pointers from findRecipientById(). Call markDirty() once the
+    // lock is released.
+    std::unique_lock<std::recursive_mutex> lockForUpdate() {
+        return std::unique_lock<std::recursive_mutex>(listMutex);
+    }
+
+    // Records a change to the recipients. With background saving it is
+    // saved later; otherwise it is saved now.
+    void markDirty() {
+        if (!saver.joinable()) {
+            forceSave();
+            return;
+        }
+        std::lock_guard<std::mutex> lock(saverMutex);
+        if (++dirtyCount >= autosave.changes) saverWake.notify_one();
+    }
+
     void forceSave() {
+        std::lock_guard<std::recursive_mutex> lock(listMutex);
         saveToFile();
-        if(autoSave) {
+        requestStore.flush();
+        if (autoSave && isVerbose(VERBOSITY_NORMAL)) {
             cout << "Recipient data saved successfully." << endl;
         }
     }
     void loadFromFile() {
+        ScopedTimer timer(PERF_RECIPIENTS_LOAD);
+        std::lock_guard<std::recursive_mutex> lock(listMutex);
+        GroupCommitter::instance().flush();
         ifstream in(SAVE_FILE);
         if (!in.is_open()) return;
     
@@ -218,74 +367,74 @@ class RecipientNode {
         }
     }
 
-    RecipientNode* getHead() const { return head; }
+    RecipientNode* getHead() const {
+        return nodes.empty() ? nullptr : const_cast<RecipientNode*>(&nodes.front());
+    }
+
+    // Linear iteration over the contiguous storage.
+    std::vector<RecipientNode>::const_iterator begin() const { return nodes.begin(); }
+    std::vector<RecipientNode>::const_iterator end() const { return nodes.end(); }
+    std::vector<RecipientNode>::iterator begin() { return nodes.begin(); }
+    std::vector<RecipientNode>::iterator end() { return nodes.end(); }
     
     void addRecipient(const recipient& rec) {
+        std::unique_lock<std::recursive_mutex> lock(listMutex);
         if (recipientMap.find(rec.get_id()) != recipientMap.end()) {
             cerr << "Error: Recipient ID " << rec.get_id() << " already exists!\n";
             return;
         }
 
-        RecipientNode* newNode = new RecipientNode(rec);
-        if (!head) {
-            head = tail = newNode;
-        } else {
-            tail->next = newNode;
-            tail = newNode;
+        const RecipientNode* oldData = nodes.data();
+        nodes.emplace_back(rec);
+        nodes.back().rec.attach_request_store(&requestStore);
+        if (nodes.data() != oldData) {
+            relink();
+        } else if (nodes.size() > 1) {
+            nodes[nodes.size() - 2].next = &nodes.back();
         }
-        recipientMap[rec.get_id()] = newNode;
-        size++;
+        recipientMap[rec.get_id()] = nodes.size() - 1;
+        lock.unlock();
         
-        if (autoSave) forceSave();
+        if (autoSave) markDirty();
     }
     
     void updateRecipient(int id, float kg) {
         recipient* rec = findRecipientById(id);
         if (rec) {
-            *rec += kg;
-            forceSave(); // Save after updating
+            {
+                std::lock_guard<std::recursive_mutex> lock(listMutex);
+                *rec += kg;
+            }
+            markDirty(); // Save after updating
         }
     }
 
 
+    // The returned pointer is valid until the next addRecipient().
     recipient* findRecipientById(int id) {
-        RecipientNode* current = head;
-        while (current) {
-            if (current->rec.get_id() == id) {
-                return &(current->rec);
-            }
-            current = current->next;
-        }
-        return nullptr;
+        ScopedTimer timer(PERF_FIND_RECIPIENT);
+        auto it = recipientMap.find(id);
+        return it == recipientMap.end() ? nullptr : &nodes[it->second].rec;
     }
 
     const recipient* findRecipientById(int id) const {
-        RecipientNode* current = head;
-        while (current) {
-            if (current->rec.get_id() == id) {
-                return &(current->rec);
-            }
-            current = current->next;
-        }
-        return nullptr;
+        ScopedTimer timer(PERF_FIND_RECIPIENT);
+        auto it = recipientMap.find(id);
+        return it == recipientMap.end() ? nullptr : &nodes[it->second].rec;
     }
 
     void displayAllRecipients() const {
-        RecipientNode* current = head;
-        while (current) {
-            current->rec.display();
-            current = current->next;
+        for (const auto& node : nodes) {
+            node.rec.display();
         }
     }
 
-    int getSize() const { return size; }
+    int getSize() const { return static_cast<int>(nodes.size()); }
 
     int getTotalDistributedFood() const {
         int total = 0;
-        RecipientNode* current = head;
-        while (current) {
-            total += current->rec.get_total_kg();
-            current = current->next;
+        for (const auto& node : nodes) {
+            total += node.rec.get_total_kg();
         }
         return total;
     }
@@ -296,14 +445,12 @@ class RecipientNode {
 
     void clearDataFile() {
         // Clear in-memory data
+        std::lock_guard<std::recursive_mutex> lock(listMutex);
         clear();
+        requestStore.clear();
         
         // Clear the file
-        ofstream file(SAVE_FILE, ios::trunc);
-        if (!file) {
-            throw runtime_error("Failed to clear recipients file");
-        }
-        file.close();
+        GroupCommitter::instance().replace(SAVE_FILE, "");
         
         cout << "Recipients file cleared successfully.\n";
     }
@@ -0,0 +1,132 @@
+#ifndef REPORT_WRITER_H
+#define REPORT_WRITER_H
+
+#include <iostream>
+#include <ostream>
+#include <streambuf>
+#include <vector>
+#include <string>
+#include <cerrno>
+#include <unistd.h>
+
+// How much status chatter is printed around the reports themselves.
+//   QUIET    reports and prompts only
+//   NORMAL   plus save confirmations and similar notices
+//   DEBUG    plus per-save record counts
+enum Verbosity { VERBOSITY_QUIET, VERBOSITY_NORMAL, VERBOSITY_DEBUG };
+
+Verbosity& verbosity() {
+    static Verbosity level = VERBOSITY_NORMAL;
+    return level;
+}
+
+bool isVerbose(Verbosity level) { return verbosity() >= level; }
+
+// Where reports printed on this thread go: stdout when null, or a string
+// while the service (see service.h) renders a reply for a client.
+std::string*& reportCapture() {
+    static thread_local std::string* capture = nullptr;
+    return capture;
+}
+
+// Stream buffer that collects output in a large block and hands it to
+// write(2), or appends it to a string, only when the block fills up or the
+// stream is flushed.
+class ReportBuffer : public std::streambuf {
+private:
+    std::vector<char>& block;
+    int fd;
+    std::string* capture;
+
+    bool writeAll(const char* data, size_t size) {
+        while (size > 0) {
+            ssize_t written = ::write(fd, data, size);
+            if (written < 0) {
+                if (errno == EINTR) continue;
+                return false;
+            }
+            data += written;
+            size -= static_cast<size_t>(written);
+        }
+        return true;
+    }
+
+protected:
+    int overflow(int c) override {
+        if (sync() != 0) return traits_type::eof();
+        if (!traits_type::eq_int_type(c, traits_type::eof())) {
+            *pptr() = traits_type::to_char_type(c);
+            pbump(1);
+        }
+        return traits_type::not_eof(c);
+    }
+
+    int sync() override {
+        size_t size = static_cast<size_t>(pptr() - pbase());
+        bool ok = true;
+        if (capture) capture->append(pbase(), size);
+        else ok = writeAll(pbase(), size);
+        setp(block.data(), block.data() + block.size());
+        return ok ? 0 : -1;
+    }
+
+public:
+    ReportBuffer(std::vector<char>& b, int f, std::string* c = nullptr) : block(b), fd(f), capture(c) {
+        setp(block.data(), block.data() + block.size());
+    }
+};
+
+// Output stream for one report. Everything written to it goes into a
+// 256 KiB block that is reused by every report on the thread, so printing
+// a long report costs a handful of write calls and no allocations. Use '\n'
+// rather than std::endl, which would flush each line. The destructor writes
+// whatever is left.
+class ReportWriter : public std::ostream {
+private:
+    static const size_t BLOCK_SIZE = 256 * 1024;
+
+    std::vector<char> ownBlock;  // only if the shared block is taken
+    bool usesShared;
+    ReportBuffer buffer;
+
+    static bool& sharedInUse() {
+        static thread_local bool inUse = false;
+        return inUse;
+    }
+
+    static std::vector<char>& sharedBlock() {
+        static thread_local std::vector<char> block(BLOCK_SIZE);
+        return block;
+    }
+
+    std::vector<char>& claimBlock() {
+        if (!sharedInUse()) {
+            sharedInUse() = true;
+            usesShared = true;
+            return sharedBlock();
+        }
+        ownBlock.resize(BLOCK_SIZE);
+        return ownBlock;
+    }
+
+public:
+    // Prints to stdout, or into the thread's reportCapture() if one is set.
+    ReportWriter() : ReportWriter(STDOUT_FILENO, reportCapture()) {}
+
+    explicit ReportWriter(int fd, std::string* capture = nullptr)
+        : std::ostream(nullptr), usesShared(false), buffer(claimBlock(), fd, capture) {
+        // Anything already printed through std::cout has to come first.
+        if (fd == STDOUT_FILENO && !capture) std::cout.flush();
+        rdbuf(&buffer);
+    }
+
+    ~ReportWriter() {
+        flush();
+        if (usesShared) sharedInUse() = false;
+    }
+
+    ReportWriter(const ReportWriter&) = delete;
+    ReportWriter& operator=(const ReportWriter&) = delete;
+};
+
+#endif
@@ -6,106 +6,129 @@
 #include <map>
 #include <numeric>
 #include <algorithm>
+#include <unordered_set>
 #include "donation.h"
+#include "donation_journal.h"
+#include "donation_pager.h"
+#include "donation_totals.h"
+#include "parallel_aggregate.h"
 #include "recipient.h"
 #include "donor.h"
+#include "report_writer.h"
+#include "perf_stats.h"
 
 class Reporting {
 private:
     std::vector<Donation> donations;
     RecipientLinkedList& recipients;
     DonorManager& donorManager;
-    const std::string dataFile = "donations.dat";
+    DonationJournal journal;
+    size_t savedCount;  // donations[0..savedCount) are already on disk
+    // Per-donor and per-recipient totals, kept current as donations come and
+    // go. The distribution report, the summaries and the rankings read these
+    // rather than running a group-by, which would rescan the whole history
+    // for figures that are already at hand; the engine rebuilds them in
+    // recomputeTotals() and serves the audit and breakdown reports.
+    DonationTotals totals;
+    ParallelAggregator aggregator;
+
+    // Positions in donations ordered by date (ties in insertion order).
+    // Built on first use and dropped whenever donations are removed.
+    std::vector<uint32_t> dateIndex;
+    bool dateIndexValid;
+
+    void ensureDateIndex() {
+        if (dateIndexValid) return;
+        dateIndex.resize(donations.size());
+        std::iota(dateIndex.begin(), dateIndex.end(), 0);
+        std::stable_sort(dateIndex.begin(), dateIndex.end(),
+            [this](uint32_t a, uint32_t b) {
+                return donations[a].getDayNumber() < donations[b].getDayNumber();
+            });
+        dateIndexValid = true;
+    }
 
     void loadDonations() {
-        std::ifstream in(dataFile);
-        if (in) {
-            donations.clear();
-            while (in.peek() != EOF) {
-                donations.push_back(Donation::load(in));
-            }
+        ScopedTimer timer(PERF_DONATIONS_LOAD);
+        journal.load(donations);
+        savedCount = donations.size();
+        dateIndexValid = false;
+        recomputeTotals();
+        if (journal.needsCompaction(donations.size())) {
+            ScopedTimer compactTimer(PERF_DONATIONS_COMPACT);
+            journal.compact(donations);
         }
     }
 
+    // Appends the donations added since the last save to the journal.
     void saveDonations() {
-        std::ofstream out(dataFile);
-        for (const auto& d : donations) {
-            d.save(out);
+        ScopedTimer timer(PERF_DONATIONS_SAVE);
+        if (isVerbose(VERBOSITY_DEBUG) && savedCount < donations.size()) {
+            std::cout << "DEBUG: Saving " << donations.size() - savedCount << " donations\n";
         }
+        journal.append(donations, savedCount);
+        savedCount = donations.size();
     }
 
-    
-
-    void rankByDonationFrequency() {
+public:
+    // Top-k donor tables, printed by displayDonorRankings().
+    void rankByDonationFrequency(size_t k) {
+        ScopedTimer timer(PERF_RANK_FREQUENCY);
+        ReportWriter out;
         const std::vector<Donor>& donors = donorManager.getDonors();
-        std::vector<Donor> sortedDonors = donors;
+        std::vector<size_t> top = topDonors(k, BY_FREQUENCY);
 
-        std::sort(sortedDonors.begin(), sortedDonors.end(),
-            [](const Donor& a, const Donor& b) {
-                return a.get_donation_frequency() > b.get_donation_frequency();
-            });
-
-        std::cout << "\n=== Donor Rankings by Frequency ===\n";
-        std::cout << "Rank\tName\t\tDonations\n";
-        std::cout << "--------------------------------\n";
-        for (size_t i = 0; i < sortedDonors.size(); i++) {
-            std::cout << i+1 << ".\t" << sortedDonors[i].get_name() 
-                     << "\t\t" << sortedDonors[i].get_donation_frequency() << std::endl;
+        out << "\n=== Donor Rankings by Frequency ===\n";
+        out << "Rank\tName\t\tDonations\n";
+        out << "--------------------------------\n";
+        for (size_t i = 0; i < top.size(); i++) {
+            const Donor& donor = donors[top[i]];
+            out << i+1 << ".\t" << donor.get_name() 
+                << "\t\t" << donor.get_donation_frequency() << "\n";
         }
-        std::cout << "================================\n\n";
+        out << "================================\n\n";
     }
 
-    void rankByTotalKgDonated() {
+    void rankByTotalKgDonated(size_t k) {
+        ScopedTimer timer(PERF_RANK_KG);
+        ReportWriter out;
         const std::vector<Donor>& donors = donorManager.getDonors();
-        std::vector<Donor> sortedDonors = donors;
-
-        for (auto& donor : sortedDonors) {
-            float totalKg = 0;
-            for (const auto& donation : donations) {
-                if (donation.getDonorName() == donor.get_name()) {
-                    totalKg += donation.getQuantity();
-                }
-            }
-            donor.set_temp_kg(totalKg);
-        }
-
-        std::sort(sortedDonors.begin(), sortedDonors.end(),
-            [](const Donor& a, const Donor& b) {
-                return a.get_temp_kg() > b.get_temp_kg();
-            });
+        std::vector<size_t> top = topDonors(k, BY_KG);
 
-        std::cout << "\n=== Donor Rankings by Kg Donated ===\n";
-        std::cout << "Rank\tName\t\tKg Donated\n";
-        std::cout << "--------------------------------\n";
-        for (size_t i = 0; i < sortedDonors.size(); i++) {
-            std::cout << i+1 << ".\t" << sortedDonors[i].get_name() 
-                     << "\t\t" << sortedDonors[i].get_temp_kg() << " kg" << std::endl;
+        out << "\n=== Donor Rankings by Kg Donated ===\n";
+        out << "Rank\tName\t\tKg Donated\n";
+        out << "--------------------------------\n";
+        for (size_t i = 0; i < top.size(); i++) {
+            const Donor& donor = donors[top[i]];
+            out << i+1 << ".\t" << donor.get_name() 
+                << "\t\t" << static_cast<float>(totals.forDonor(donor.get_id()).kg) << " kg\n";
         }
-        std::cout << "================================\n\n";
+        out << "================================\n\n";
     }
 
-    void rankByTotalMoneyDonated() {
+    void rankByTotalMoneyDonated(size_t k) {
+        ScopedTimer timer(PERF_RANK_MONEY);
+        ReportWriter out;
         const std::vector<Donor>& donors = donorManager.getDonors();
-        std::vector<Donor> sortedDonors = donors;
-    
-        std::sort(sortedDonors.begin(), sortedDonors.end(),
-            [](const Donor& a, const Donor& b) {
-                return a.get_money_donated() > b.get_money_donated();
-            });
+        std::vector<size_t> top = topDonors(k, BY_MONEY);
     
-        std::cout << "\n=== Donor Rankings by Money Donated ===\n";
-        std::cout << "Rank\tName\t\tAmount Donated\n";
-        std::cout << "--------------------------------\n";
-        for (size_t i = 0; i < sortedDonors.size(); i++) {
-            std::cout << i+1 << ".\t" << sortedDonors[i].get_name() 
-                     << "\t\t$" << std::fixed << std::setprecision(2) 
-                     << sortedDonors[i].get_money_donated() << std::endl;
+        out << "\n=== Donor Rankings by Money Donated ===\n";
+        out << "Rank\tName\t\tAmount Donated\n";
+        out << "--------------------------------\n";
+        for (size_t i = 0; i < top.size(); i++) {
+            const Donor& donor = donors[top[i]];
+            out << i+1 << ".\t" << donor.get_name() 
+                << "\t\t$" << std::fixed << std::setprecision(2) 
+                << totals.forDonor(donor.get_id()).money() << "\n";
         }
-        std::cout << "================================\n\n";
+        out << "================================\n\n";
     }
 
-public:
-    Reporting(DonorManager& dm, RecipientLinkedList& r) : donorManager(dm), recipients(r) {
+    // reportThreads > 1 runs full passes over the donations (loading, audits)
+    // on that many worker threads.
+    Reporting(DonorManager& dm, RecipientLinkedList& r, size_t reportThreads = 1)
+        : recipients(r), donorManager(dm), journal("donations.dat", "donations.journal"), savedCount(0),
+          aggregator(reportThreads), dateIndexValid(false) {
         loadDonations();
     }
 
@@ -113,15 +136,193 @@ public:
         saveDonations();
     }
 
-    std::vector<Donation>& getDonations() { return donations; }
+    const std::vector<Donation>& getDonations() const { return donations; }
 
     void addDonation(const Donation& donation) {
         donations.push_back(donation);
+        totals.add(donation);
+        if (dateIndexValid) {
+            // Usually the newest date, so the insert lands at the end.
+            int32_t day = donation.getDayNumber();
+            auto pos = std::upper_bound(dateIndex.begin(), dateIndex.end(), day,
+                [this](int32_t d, uint32_t i) { return d < donations[i].getDayNumber(); });
+            dateIndex.insert(pos, static_cast<uint32_t>(donations.size() - 1));
+        }
+    }
+
+    // Calls f for each donation dated from..to inclusive, in date order.
+    // Binary-searches the date index, so only matching records are touched.
+    template <typename F>
+    void forEachDonationBetween(Date from, Date to, F f) {
+        ensureDateIndex();
+        auto first = std::lower_bound(dateIndex.begin(), dateIndex.end(), from.dayNumber(),
+            [this](uint32_t i, int32_t d) { return donations[i].getDayNumber() < d; });
+        auto last = std::upper_bound(first, dateIndex.end(), to.dayNumber(),
+            [this](int32_t d, uint32_t i) { return d < donations[i].getDayNumber(); });
+        for (auto it = first; it != last; ++it) f(donations[*it]);
+    }
+
+    void generateDateRangeReport(Date from, Date to) {
+        ScopedTimer timer(PERF_REPORT_DATE_RANGE);
+        ReportWriter out;
+        DonationTally range;
+        out << "\n=== Donations " << from.toString() << " to " << to.toString() << " ===\n";
+        forEachDonationBetween(from, to, [&range, &out](const Donation& d) {
+            d.printDetails(out);
+            range.add(d);
+        });
+        if (range.count == 0) out << "No donations in this period.\n";
+        out << "══════════════════════\n"
+            << "Donations: " << range.count << "\n"
+            << "Total Money Donated: $" << std::fixed << std::setprecision(2) << range.money() << "\n"
+            << "Total Food Donated: " << range.kg << " kg\n"
+            << "══════════════════════\n";
+    }
+
+    // Rebuilds the running totals from the full history with the
+    // aggregation engine.
+    void recomputeTotals() {
+        GroupByResult result = aggregator.run(donations, {GROUP_DONOR, GROUP_RECIPIENT});
+        std::unordered_map<int, DonationTally> byDonor, byRecipient;
+        result.table(GROUP_DONOR).forEach([&byDonor](int64_t id, const GroupRow& row) {
+            byDonor[static_cast<int>(id)] = row.tally;
+        });
+        result.table(GROUP_RECIPIENT).forEach([&byRecipient](int64_t id, const GroupRow& row) {
+            byRecipient[static_cast<int>(id)] = row.tally;
+        });
+        totals.assign(result.overall.tally, std::move(byDonor), std::move(byRecipient));
+    }
+
+    // Runs one group-by pass over the whole history for the given keys.
+    GroupByResult groupBy(const std::vector<GroupKey>& keys) const {
+        return aggregator.run(donations, keys);
+    }
+
+    std::string groupLabel(GroupKey key, int64_t value) const {
+        switch (key) {
+            case GROUP_DONOR: {
+                const Donor* donor = donorManager.find_donor_by_id(static_cast<int>(value));
+                return donor ? donor->get_name() : "#" + std::to_string(value);
+            }
+            case GROUP_RECIPIENT: {
+                const recipient* rec = recipients.findRecipientById(static_cast<int>(value));
+                return rec ? rec->get_name() : "#" + std::to_string(value);
+            }
+            case GROUP_FOOD_TYPE:
+                return StringPool::instance().get(static_cast<uint32_t>(value));
+            case GROUP_YEAR:
+                return value == 0 ? "unknown" : std::to_string(value);
+            case GROUP_MONTH: {
+                if (value == 0) return "unknown";
+                std::string month = std::to_string(value % 100);
+                return std::to_string(value / 100) + "-" + (month.size() < 2 ? "0" : "") + month;
+            }
+        }
+        return "";
+    }
+
+    void printGroupTable(std::ostream& out, const GroupByResult& result, GroupKey key, int measures) const {
+        static const char* TITLES[] = {"Donor", "Recipient", "Food Type", "Year", "Month"};
+        out << TITLES[key];
+        if (measures & MEASURE_COUNT) out << "\tDonations";
+        if (measures & MEASURE_KG) out << "\tFood (kg)";
+        if (measures & MEASURE_MONEY) out << "\tMoney ($)";
+        if (measures & MEASURE_MIN_MAX) out << "\tMin-Max kg\tMin-Max $";
+        out << "\n------------------------------------------------\n";
+
+        // Named groups are listed alphabetically, numbered ones in key order.
+        const FlatGroupTable& table = result.table(key);
+        std::vector<std::pair<std::string, int64_t>> groups;
+        for (int64_t k : table.sortedKeys()) groups.emplace_back(groupLabel(key, k), k);
+        if (key == GROUP_DONOR || key == GROUP_FOOD_TYPE) {
+            std::stable_sort(groups.begin(), groups.end(),
+                [](const std::pair<std::string, int64_t>& a, const std::pair<std::string, int64_t>& b) {
+                    return a.first < b.first;
+                });
+        }
+
+        for (const auto& group : groups) {
+            const GroupRow& row = *table.find(group.second);
+            out << group.first;
+            if (measures & MEASURE_COUNT) out << "\t" << row.tally.count;
+            if (measures & MEASURE_KG) out << "\t" << row.tally.kg;
+            if (measures & MEASURE_MONEY) {
+                out << "\t" << std::fixed << std::setprecision(2) << row.tally.money();
+            }
+            if (measures & MEASURE_MIN_MAX) {
+                out << "\t" << row.minKg << "-" << row.maxKg << "\t"
+                    << std::fixed << std::setprecision(2)
+                    << row.minCents / 100.0 << "-" << row.maxCents / 100.0;
+            }
+            out << "\n";
+        }
+    }
+
+    // Full recount of the history by month and by food type, in one pass.
+    void generateAuditReport() {
+        ScopedTimer timer(PERF_REPORT_AUDIT);
+        ReportWriter out;
+        if (donations.empty()) {
+            out << "No donations recorded.\n";
+            return;
+        }
+        GroupByResult result = groupBy({GROUP_MONTH, GROUP_FOOD_TYPE});
+
+        out << "\n=== Monthly Audit ===\n";
+        printGroupTable(out, result, GROUP_MONTH, MEASURE_COUNT | MEASURE_KG | MEASURE_MONEY);
+        out << "\n";
+        printGroupTable(out, result, GROUP_FOOD_TYPE, MEASURE_COUNT | MEASURE_KG);
+        const DonationTally& all = result.overall.tally;
+        out << "================================================\n"
+            << "Total: " << all.count << " donations, " << all.kg << " kg, $"
+            << std::fixed << std::setprecision(2) << all.money() << "\n";
+    }
+
+    void generateBreakdownReport(GroupKey key, int measures) {
+        ScopedTimer timer(PERF_REPORT_BREAKDOWN);
+        ReportWriter out;
+        if (donations.empty()) {
+            out << "No donations recorded.\n";
+            return;
+        }
+        GroupByResult result = groupBy({key});
+        out << "\n=== Donation Breakdown ===\n";
+        printGroupTable(out, result, key, measures);
+        out << "================================================\n";
+    }
+
+    enum DonorMetric { BY_FREQUENCY, BY_KG, BY_MONEY };
+
+    // Positions in donorManager.getDonors() of the k highest-ranked donors,
+    // best first (ties keep registration order). Only an index permutation
+    // is sorted, and only its first k entries, so no Donor is copied.
+    std::vector<size_t> topDonors(size_t k, DonorMetric metric) const {
+        const std::vector<Donor>& donors = donorManager.getDonors();
+        std::vector<double> score(donors.size());
+        for (size_t i = 0; i < donors.size(); i++) {
+            switch (metric) {
+                case BY_FREQUENCY: score[i] = donors[i].get_donation_frequency(); break;
+                case BY_KG:        score[i] = totals.forDonor(donors[i].get_id()).kg; break;
+                case BY_MONEY:     score[i] = totals.forDonor(donors[i].get_id()).cents; break;
+            }
+        }
+
+        std::vector<size_t> order(donors.size());
+        std::iota(order.begin(), order.end(), 0);
+        k = std::min(k, order.size());
+        std::partial_sort(order.begin(), order.begin() + k, order.end(),
+            [&score](size_t a, size_t b) {
+                return score[a] > score[b] || (score[a] == score[b] && a < b);
+            });
+        order.resize(k);
+        return order;
     }
 
     void generateDonationReport(int sortType = 0) {  // 0=quantity, 1=date, 2=money
+        ScopedTimer timer(PERF_REPORT_DONATIONS);
+        ReportWriter out;
         if (donations.empty()) {
-            cout << "No donations recorded.\n";
+            out << "No donations recorded.\n";
             return;
         }
     
@@ -133,7 +334,7 @@ public:
             case 1:  // Date (newest first)
                 std::sort(sortedDonations.begin(), sortedDonations.end(),
                     [](const Donation& a, const Donation& b) {
-                        return a.getDate() > b.getDate();  // Implement date comparison
+                        return a.getDayNumber() > b.getDayNumber();
                     });
                 break;
             case 2:  // Money (highest first)
@@ -150,104 +351,117 @@ public:
                     });
         }
     
-        float totalMoney = 0;
-        float totalFood = 0;
-    
-        cout << "\n=== Donation Report ===\n";
+        out << "\n=== Donation Report ===\n";
         for (const auto& donation : sortedDonations) {
-            donation.printDetails();
-            if (donation.isMoneyDonation()) {
-                totalMoney += donation.getMoneyAmount();
-            } else {
-                totalFood += donation.getQuantity();
-            }
+            donation.printDetails(out);
         }
     
-        cout << "══════════════════════\n"
-             << "Total Money Donated: $" << fixed << setprecision(2) << totalMoney << "\n"
-             << "Total Food Donated: " << totalFood << " kg\n"
-             << "══════════════════════\n";
+        const DonationTally& all = totals.global();
+        out << "══════════════════════\n"
+            << "Total Money Donated: $" << std::fixed << std::setprecision(2) << all.money() << "\n"
+            << "Total Food Donated: " << static_cast<double>(all.kg) << " kg\n"
+            << "══════════════════════\n";
+    }
+
+    // A page-at-a-time view of the donation report; see DonationPager.
+    DonationPager pageDonations(DonationOrder order, size_t pageSize = 20) {
+        ScopedTimer timer(PERF_REPORT_DONATION_PAGE);
+        if (order == ORDER_DATE) ensureDateIndex();
+        return DonationPager(donations, order, dateIndex, pageSize);
+    }
+
+    void printDonationPage(DonationPager& pager) {
+        ScopedTimer timer(PERF_REPORT_DONATION_PAGE);
+        ReportWriter out;
+        if (donations.empty()) {
+            out << "No donations recorded.\n";
+            return;
+        }
+
+        out << "\n=== Donation Report (page " << pager.page() + 1 << " of " << pager.pageCount() << ") ===\n";
+        pager.forEachOnPage([&out](const Donation& donation) { donation.printDetails(out); });
+
+        if (!pager.hasNext()) {
+            const DonationTally& all = totals.global();
+            out << "══════════════════════\n"
+                << "Total Money Donated: $" << std::fixed << std::setprecision(2) << all.money() << "\n"
+                << "Total Food Donated: " << static_cast<double>(all.kg) << " kg\n"
+                << "══════════════════════\n";
+        }
     }
 
     void generateDistributionReport() {
+        ScopedTimer timer(PERF_REPORT_DISTRIBUTION);
+        ReportWriter out;
         if (recipients.getSize() == 0) {
-            std::cout << "No recipients available for reporting." << std::endl;
+            out << "No recipients available for reporting.\n";
             return;
         }
         
-        // Calculate total money received per recipient
-        std::unordered_map<int, float> moneyReceived;
-        for (const auto& donation : donations) {
-            if (donation.isMoneyDonation()) {
-                moneyReceived[donation.getRecipientId()] += donation.getMoneyAmount();
-            }
-        }
-        
-        std::cout << "=== Recipient Distribution Report ===\n";
+        out << "=== Recipient Distribution Report ===\n";
         RecipientNode* current = recipients.getHead();
         while (current) {
-            current->rec.display();
-            if (moneyReceived.count(current->rec.get_id())) {
-                std::cout << "Total Money Received: $" << std::fixed << std::setprecision(2) 
-                          << moneyReceived[current->rec.get_id()] << std::endl;
+            current->rec.display(out);
+            DonationTally received = totals.forRecipient(current->rec.get_id());
+            if (received.moneyCount > 0) {
+                out << "Total Money Received: $" << std::fixed << std::setprecision(2) 
+                    << received.money() << "\n";
             }
-            std::cout << "--------------------------------\n";
+            out << "--------------------------------\n";
             current = current->next;
         }
     }
 
     void generateDonorReport() {
+        ScopedTimer timer(PERF_REPORT_DONORS);
+        ReportWriter out;
         const auto& donors = donorManager.getDonors();
         if (donors.empty()) {
-            std::cout << "No donors available for reporting." << std::endl;
+            out << "No donors available for reporting.\n";
             return;
         }
     
-        std::cout << "=== Donor Report ===\n";
-        std::cout << "ID\tName\t\tContact\t\tDonations\n";
-        std::cout << "------------------------------------------------\n";
+        out << "=== Donor Report ===\n";
+        out << "ID\tName\t\tContact\t\tDonations\n";
+        out << "------------------------------------------------\n";
         
         for (const auto& donor : donors) {
-            std::cout << donor.get_id() << "\t"
-                     << donor.get_name() << "\t\t"
-                     << donor.get_contact_details() << "\t\t"
-                     << donor.get_donation_frequency() << std::endl;
+            out << donor.get_id() << "\t"
+                << donor.get_name() << "\t\t"
+                << donor.get_contact_details() << "\t\t"
+                << donor.get_donation_frequency() << "\n";
         }
-        std::cout << "================================================\n";
+        out << "================================================\n";
     }
 
     void generateOverallSummary() {
-        int totalDonations = donations.size();
-        int totalQuantity = std::accumulate(donations.begin(), donations.end(), 0,
-                                      [](int sum, const Donation& donation) {
-                                          return sum + (donation.isMoneyDonation() ? 0 : donation.getQuantity());
-                                      });
-        float totalMoney = std::accumulate(donations.begin(), donations.end(), 0.0f,
-                                      [](float sum, const Donation& donation) {
-                                          return sum + (donation.isMoneyDonation() ? donation.getMoneyAmount() : 0);
-                                      });
+        ScopedTimer timer(PERF_REPORT_OVERALL_SUMMARY);
+        ReportWriter out;
+        const DonationTally& all = totals.global();
+        size_t totalDonations = all.count;
+        long long totalQuantity = all.kg;
+        double totalMoney = all.money();
     
-        std::cout << "Overall Summary of Donations:" << std::endl;
-        std::cout << "Total Donations: " << totalDonations << std::endl;
-        std::cout << "Total Food Donated: " << totalQuantity << " kg" << std::endl;
-        std::cout << "Total Money Donated: $" << std::fixed << std::setprecision(2) << totalMoney << std::endl;
-        std::cout << "----------------------------------" << std::endl;
+        out << "Overall Summary of Donations:\n";
+        out << "Total Donations: " << totalDonations << "\n";
+        out << "Total Food Donated: " << totalQuantity << " kg\n";
+        out << "Total Money Donated: $" << std::fixed << std::setprecision(2) << totalMoney << "\n";
+        out << "----------------------------------\n";
     }
     
 
     void generateDistributionSummary() {
+        ScopedTimer timer(PERF_REPORT_DISTRIBUTION_SUMMARY);
+        ReportWriter out;
         int totalRecipients = recipients.getSize();
         int totalDistributedFood = recipients.getTotalDistributedFood();
-        float totalMoney = std::accumulate(donations.begin(), donations.end(), 0.0f,
-                                      [](float sum, const Donation& donation) {
-                                          return sum + (donation.isMoneyDonation() ? donation.getMoneyAmount() : 0);
-                                      });
+        double totalMoney = totals.global().money();
     
-        std::cout << "Overall Summary of Distributions:" << std::endl;
-        std::cout << "Total Recipients: " << totalRecipients << std::endl;
-        std::cout << "Total Food Distributed: " << totalDistributedFood << " kg" << std::endl;
-        std::cout << "Total Money Distributed: $" << std::fixed << std::setprecision(2) << totalMoney << std::endl;
-        std::cout << "----------------------------------" << std::endl;
+        out << "Overall Summary of Distributions:\n";
+        out << "Total Recipients: " << totalRecipients << "\n";
+        out << "Total Food Distributed: " << totalDistributedFood << " kg\n";
+        out << "Total Money Distributed: $" << std::fixed << std::setprecision(2) << totalMoney << "\n";
+        out << "----------------------------------\n";
     }
     void displayDonorRankings() {
         int choice;
@@ -259,58 +473,77 @@ public:
                  << "Choose ranking type: ";
         std::cin >> choice;
         std::cin.ignore();
+        if (choice == 4) return;
+        if (choice < 1 || choice > 3) {
+            std::cout << "Invalid choice!\n";
+            return;
+        }
+
+        int view;
+        std::cout << "\nShow:\n"
+                 << "1. Top 10\n"
+                 << "2. Top 100\n"
+                 << "3. All\n"
+                 << "Choose view: ";
+        std::cin >> view;
+        std::cin.ignore();
+        size_t k = view == 1 ? 10 : view == 2 ? 100 : donorManager.getDonors().size();
     
         switch (choice) {
             case 1:
-                rankByDonationFrequency();
+                rankByDonationFrequency(k);
                 break;
             case 2:
-                rankByTotalKgDonated();
+                rankByTotalKgDonated(k);
                 break;
             case 3:
-                rankByTotalMoneyDonated();
+                rankByTotalMoneyDonated(k);
                 break;
-            case 4:
-                return;
-            default:
-                std::cout << "Invalid choice!\n";
         }
     }
 
     void removeDonationsByDonorId(int donorId) {
+        saveDonations(); // Pending records must reach the journal before the tombstone
         auto it = remove_if(donations.begin(), donations.end(),
-            [donorId](const Donation& d) {
-                return d.getDonorId() == donorId;
+            [this, donorId](const Donation& d) {
+                if (d.getDonorId() != donorId) return false;
+                totals.remove(d);
+                return true;
             });
+        if (it == donations.end()) return;
         donations.erase(it, donations.end());
-        saveDonations(); // Immediately update the file
+        dateIndexValid = false;
+        savedCount = donations.size();
+        journal.appendTombstone(DonationJournal::DONOR, donorId);
     }
 
     void cleanupOrphanedDonations(const DonorManager& donorManager, const RecipientLinkedList& recipients) {
+        ScopedTimer timer(PERF_CLEANUP_ORPHANS);
+        saveDonations();
+        std::unordered_set<int> missingDonors;
+        std::unordered_set<int> missingRecipients;
         donations.erase(
             std::remove_if(donations.begin(), donations.end(),
-                [&donorManager, &recipients](const Donation& d) {
-                    bool donorExists = false;
+                [&](const Donation& d) {
+                    bool donorExists = donorManager.find_donor_by_id(d.getDonorId()) != nullptr;
                     bool recipientExists = recipients.findRecipientById(d.getRecipientId()) != nullptr;
                     
-                    for (const auto& donor : donorManager.getDonors()) {
-                        if (donor.get_id() == d.getDonorId()) {
-                            donorExists = true;
-                            break;
-                        }
-                    }
-                    
-                    return !donorExists || !recipientExists;
+                    if (!donorExists) missingDonors.insert(d.getDonorId());
+                    if (!recipientExists) missingRecipients.insert(d.getRecipientId());
+                    if (donorExists && recipientExists) return false;
+                    totals.remove(d);
+                    return true;
                 }),
             donations.end()
         );
-        saveDonations();
+        dateIndexValid = false;
+        savedCount = donations.size();
+        for (int id : missingDonors) journal.appendTombstone(DonationJournal::DONOR, id);
+        for (int id : missingRecipients) journal.appendTombstone(DonationJournal::RECIPIENT, id);
     }
     
     void forceSaveAll() {
         saveDonations();  // Explicitly save donations
-        // Add debug output to verify saving
-        std::cout << "DEBUG: Saved " << donations.size() << " donations\n";
     }
 };
 
@@ -0,0 +1,393 @@
+#ifndef REQUEST_STORE_H
+#define REQUEST_STORE_H
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <iostream>
+#include <cstdio>
+#include <cstring>
+#include <cstdint>
+#include <unordered_map>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "Queue.h"
+#include "perf_stats.h"
+#include "persist.h"
+
+// Persistent pending food requests, one Queue per recipient id.
+//
+// The snapshot file holds every queue as of the last compaction (native byte
+// order):
+//   header     "FDRQ", uint32 version, uint32 recipientCount, uint32 generation,
+//              uint64 requestCount
+//   directory  {int32 recipientId, uint32 count[URGENCY_LEVELS], uint64 first}
+//              per recipient
+//   requests   int32 quantity[requestCount], by recipient, then by level,
+//              oldest first
+// The journal holds one fixed-size Op for every change since, appended as it
+// happens. Its first Op names the snapshot generation it applies to; each
+// compaction writes the snapshot under the next generation before starting a
+// new journal, so a journal left over from an earlier generation has already
+// been folded in and is skipped rather than replayed a second time.
+//
+// Queues are built lazily. Startup maps the snapshot and reads only its
+// directory, and journal ops are set aside per recipient; a recipient's queue
+// is built the first time its requests are read or removed. Per-level counts
+// are tracked for every recipient, so totals never force a queue to be built.
+class RequestStore {
+private:
+    enum OpKind { OP_ENQUEUE = '+', OP_DEQUEUE = '-', OP_REDUCE = '~', OP_GENERATION = '#' };
+
+    struct Op {
+        int32_t recipientId;
+        int32_t quantity;     // new quantity of the front request for OP_REDUCE,
+                              // the generation for OP_GENERATION
+        uint8_t kind;
+        uint8_t urgency;
+        uint8_t reserved[2];
+    };
+
+    struct Header {
+        char magic[4];
+        uint32_t version;
+        uint32_t recipientCount;
+        uint32_t generation;
+        uint64_t requestCount;
+    };
+
+    struct DirectoryEntry {
+        int32_t recipientId;
+        uint32_t count[URGENCY_LEVELS];
+        uint64_t first;
+    };
+
+    // A recipient whose queue has not been built yet.
+    struct Unloaded {
+        const int32_t* snapshot = nullptr;  // its quantities in the mapped file
+        uint32_t snapshotCount[URGENCY_LEVELS] = {0, 0, 0};
+        std::vector<Op> ops;                // journal ops on top of the snapshot
+        int count[URGENCY_LEVELS] = {0, 0, 0};
+    };
+
+    std::string snapshotFile;
+    std::string journalFile;
+    std::unordered_map<int, Queue> queues;
+    std::unordered_map<int, Unloaded> unloaded;
+    std::ofstream journal;
+    size_t journalOps;
+    size_t requestCount;
+    uint32_t generation;  // of the snapshot
+    bool journalCurrent;  // the journal on disk belongs to this generation
+    void* mapped;
+    size_t mappedSize;
+
+    static const uint32_t VERSION = 1;
+    static const size_t MIN_COMPACTION_OPS = 1024;
+
+    static void apply(Queue& queue, int recipientId, const Op& op) {
+        if (op.kind == OP_ENQUEUE) {
+            queue.enqueue(recipientId, op.quantity, op.urgency);
+        } else if (op.kind == OP_DEQUEUE) {
+            NODE done;
+            queue.dequeue(op.urgency, done);
+        } else if (op.kind == OP_REDUCE) {
+            NODE* front = queue.front(op.urgency);
+            if (front) front->set_quantity(op.quantity);
+        }
+    }
+
+    static void count(int* counts, const Op& op) {
+        if (op.kind == OP_ENQUEUE) counts[op.urgency]++;
+        else if (op.kind == OP_DEQUEUE && counts[op.urgency] > 0) counts[op.urgency]--;
+    }
+
+    void record(int recipientId, OpKind kind, int urgency, int quantity) {
+        Op op = {recipientId, quantity, static_cast<uint8_t>(kind), static_cast<uint8_t>(urgency), {0, 0}};
+        journal.write(reinterpret_cast<const char*>(&op), sizeof(op));
+        journalOps++;
+    }
+
+    void unmap() {
+        if (mapped) munmap(mapped, mappedSize);
+        mapped = nullptr;
+        mappedSize = 0;
+    }
+
+    bool mapSnapshot() {
+        int fd = ::open(snapshotFile.c_str(), O_RDONLY);
+        if (fd < 0) return false;
+        struct stat st;
+        if (fstat(fd, &st) != 0 || st.st_size < static_cast<off_t>(sizeof(Header))) {
+            ::close(fd);
+            return false;
+        }
+        size_t size = static_cast<size_t>(st.st_size);
+        void* map = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (map == MAP_FAILED) return false;
+        mapped = map;
+        mappedSize = size;
+        return true;
+    }
+
+    void readDirectory() {
+        if (!mapSnapshot()) return;
+        const char* data = static_cast<const char*>(mapped);
+        Header h;
+        std::memcpy(&h, data, sizeof(Header));
+        if (std::memcmp(h.magic, "FDRQ", 4) != 0 || h.version != VERSION) {
+            std::cerr << "Unsupported requests file " << snapshotFile << std::endl;
+            unmap();
+            return;
+        }
+        size_t available = mappedSize - sizeof(Header);
+        size_t directoryBytes = static_cast<size_t>(h.recipientCount) * sizeof(DirectoryEntry);
+        if (directoryBytes > available ||
+            h.requestCount > (available - directoryBytes) / sizeof(int32_t)) {
+            std::cerr << "Requests file is truncated" << std::endl;
+            unmap();
+            return;
+        }
+
+        // Every entry's requests must lie within the request section.
+        const char* entries = data + sizeof(Header);
+        std::vector<DirectoryEntry> directory(h.recipientCount);
+        for (uint32_t i = 0; i < h.recipientCount; i++) {
+            DirectoryEntry& e = directory[i];
+            std::memcpy(&e, entries + i * sizeof(DirectoryEntry), sizeof(e));
+            uint64_t count = 0;
+            for (int level = 0; level < URGENCY_LEVELS; level++) count += e.count[level];
+            if (e.first > h.requestCount || count > h.requestCount - e.first) {
+                std::cerr << "Requests file is corrupt" << std::endl;
+                unmap();
+                return;
+            }
+        }
+
+        const int32_t* quantities = reinterpret_cast<const int32_t*>(entries + directoryBytes);
+        for (const DirectoryEntry& e : directory) {
+            Unloaded& u = unloaded[e.recipientId];
+            u.snapshot = quantities + e.first;
+            for (int level = 0; level < URGENCY_LEVELS; level++) {
+                u.snapshotCount[level] = e.count[level];
+                u.count[level] = static_cast<int>(e.count[level]);
+            }
+        }
+        requestCount = h.requestCount;
+        generation = h.generation;
+    }
+
+    void readJournal() {
+        std::ifstream in(journalFile, std::ios::binary);
+        Op op;
+        size_t records = 0;
+        while (in.read(reinterpret_cast<char*>(&op), sizeof(op))) {
+            if (records++ == 0) {
+                // Journals written before generations were kept start with a
+                // plain op and belong to generation 0.
+                uint32_t journalGeneration = op.kind == OP_GENERATION ? static_cast<uint32_t>(op.quantity) : 0;
+                if (journalGeneration < generation) return;  // already in the snapshot
+                journalCurrent = true;
+                if (op.kind == OP_GENERATION) continue;
+            }
+            journalOps++;
+            if (op.urgency >= URGENCY_LEVELS) continue;
+            Unloaded& u = unloaded[op.recipientId];
+            int before = u.count[op.urgency];
+            count(u.count, op);
+            if (u.count[op.urgency] > before) requestCount++;
+            else if (u.count[op.urgency] < before) requestCount--;
+            u.ops.push_back(op);
+        }
+        // A record cut short by a crash is dropped so later appends line up.
+        if (journalCurrent && in.gcount() > 0) {
+            in.close();
+            if (::truncate(journalFile.c_str(), static_cast<off_t>(records * sizeof(Op))) != 0) {
+                std::cerr << "Cannot repair " << journalFile << std::endl;
+            }
+        }
+    }
+
+    void load() {
+        ScopedTimer timer(PERF_REQUESTS_LOAD);
+        readDirectory();
+        readJournal();
+    }
+
+    // Returns false if the file could not be written in full.
+    bool writeSnapshot(const std::string& path, uint32_t snapshotGeneration) {
+        std::vector<DirectoryEntry> directory;
+        std::vector<int> quantities;
+        for (const auto& entry : queues) {
+            if (entry.second.isEmpty()) continue;
+            DirectoryEntry e;
+            e.recipientId = entry.first;
+            e.first = quantities.size();
+            for (int level = 0; level < URGENCY_LEVELS; level++) {
+                e.count[level] = static_cast<uint32_t>(entry.second.getSize(level));
+                entry.second.quantities(level, quantities);
+            }
+            directory.push_back(e);
+        }
+
+        Header h;
+        std::memcpy(h.magic, "FDRQ", 4);
+        h.version = VERSION;
+        h.recipientCount = static_cast<uint32_t>(directory.size());
+        h.generation = snapshotGeneration;
+        h.requestCount = quantities.size();
+
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        out.write(reinterpret_cast<const char*>(&h), sizeof(h));
+        out.write(reinterpret_cast<const char*>(directory.data()), directory.size() * sizeof(DirectoryEntry));
+        out.write(reinterpret_cast<const char*>(quantities.data()), quantities.size() * sizeof(int32_t));
+        out.flush();
+        return out.good();
+    }
+
+    // Empties the journal and stamps it with the current generation.
+    void startJournal() {
+        journal.close();
+        journal.open(journalFile, std::ios::binary | std::ios::trunc);
+        Op op = {0, static_cast<int32_t>(generation), OP_GENERATION, 0, {0, 0}};
+        journal.write(reinterpret_cast<const char*>(&op), sizeof(op));
+        journal.flush();
+        syncFile(journalFile);
+        journalOps = 0;
+        journalCurrent = true;
+    }
+
+    // Writes the built queues as the snapshot of the next generation and
+    // starts a journal for it. The snapshot is synced and renamed into place
+    // first; if that fails, the old snapshot and journal are kept as they
+    // are and nothing is lost.
+    bool commitSnapshot() {
+        std::string tmpFile = snapshotFile + ".tmp";
+        if (!writeSnapshot(tmpFile, generation + 1) || !syncFile(tmpFile) ||
+            std::rename(tmpFile.c_str(), snapshotFile.c_str()) != 0) {
+            std::cerr << "Cannot save " << snapshotFile << "; keeping the journal" << std::endl;
+            std::remove(tmpFile.c_str());
+            return false;
+        }
+        syncDirectory(directoryOf(snapshotFile));
+        generation++;
+        startJournal();
+        return true;
+    }
+
+public:
+    RequestStore(const std::string& snapshot, const std::string& journalPath)
+        : snapshotFile(snapshot), journalFile(journalPath), journalOps(0), requestCount(0),
+          generation(0), journalCurrent(false), mapped(nullptr), mappedSize(0) {
+        load();
+        if (journalCurrent) journal.open(journalFile, std::ios::binary | std::ios::app);
+        else startJournal();
+    }
+
+    ~RequestStore() {
+        flush();
+        if (needsCompaction()) compact();
+        unmap();
+    }
+
+    // The queue of one recipient, built from the snapshot and journal on
+    // first use.
+    Queue& queue(int recipientId) {
+        auto built = queues.find(recipientId);
+        if (built != queues.end()) return built->second;
+
+        Queue& q = queues[recipientId];
+        auto it = unloaded.find(recipientId);
+        if (it != unloaded.end()) {
+            const Unloaded& u = it->second;
+            const int32_t* quantity = u.snapshot;
+            for (int level = 0; level < URGENCY_LEVELS; level++) {
+                for (uint32_t i = 0; i < u.snapshotCount[level]; i++) {
+                    q.enqueue(recipientId, *quantity++, level);
+                }
+            }
+            for (const Op& op : u.ops) apply(q, recipientId, op);
+            unloaded.erase(it);
+        }
+        return q;
+    }
+
+    int pending(int recipientId, int urgency) const {
+        auto built = queues.find(recipientId);
+        if (built != queues.end()) return built->second.getSize(urgency);
+        auto it = unloaded.find(recipientId);
+        return it == unloaded.end() ? 0 : it->second.count[urgency];
+    }
+
+    int pending(int recipientId) const {
+        int total = 0;
+        for (int level = 0; level < URGENCY_LEVELS; level++) total += pending(recipientId, level);
+        return total;
+    }
+
+    // Adding a request does not build the queue; it is queued up with the
+    // journal ops of a recipient that is not loaded yet.
+    void enqueue(int recipientId, int quantity, int urgency) {
+        if (urgency < NORMAL) urgency = NORMAL;
+        if (urgency > CRITICAL) urgency = CRITICAL;
+        record(recipientId, OP_ENQUEUE, urgency, quantity);
+        requestCount++;
+
+        auto it = unloaded.find(recipientId);
+        if (it == unloaded.end()) {
+            queue(recipientId).enqueue(recipientId, quantity, urgency);
+            return;
+        }
+        Op op = {recipientId, quantity, OP_ENQUEUE, static_cast<uint8_t>(urgency), {0, 0}};
+        it->second.ops.push_back(op);
+        it->second.count[urgency]++;
+    }
+
+    bool dequeue(int recipientId, int urgency, NODE& request) {
+        if (!queue(recipientId).dequeue(urgency, request)) return false;
+        record(recipientId, OP_DEQUEUE, urgency, 0);
+        requestCount--;
+        return true;
+    }
+
+    // Sets the quantity still owed on the oldest request at one level.
+    void reduceFront(int recipientId, int urgency, int quantity) {
+        NODE* front = queue(recipientId).front(urgency);
+        if (!front) return;
+        front->set_quantity(quantity);
+        record(recipientId, OP_REDUCE, urgency, quantity);
+    }
+
+    void flush() { journal.flush(); }
+
+    // Compaction is worth it once the journal is longer than the live data.
+    bool needsCompaction() const {
+        return journalOps >= MIN_COMPACTION_OPS && journalOps > requestCount;
+    }
+
+    // Builds every queue and folds the journal into a fresh snapshot.
+    void compact() {
+        std::vector<int> ids;
+        for (const auto& entry : unloaded) ids.push_back(entry.first);
+        for (int id : ids) queue(id);
+        unmap();
+        flush();
+        commitSnapshot();
+    }
+
+    // Drops every pending request, in memory and on disk. On disk this is
+    // an empty snapshot, so it is as crash-safe as a compaction.
+    void clear() {
+        queues.clear();
+        unloaded.clear();
+        unmap();
+        requestCount = 0;
+        flush();
+        commitSnapshot();
+    }
+};
+
+#endif
@@ -0,0 +1,373 @@
+#ifndef SERVICE_H
+#define SERVICE_H
+
+#include <string>
+#include <vector>
+#include <set>
+#include <mutex>
+#include <random>
+#include <sstream>
+#include <iostream>
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include "donor.h"
+#include "recipient.h"
+#include "donation.h"
+#include "inventory.h"
+#include "reporting.h"
+#include "report_writer.h"
+#include "thread_pool.h"
+
+// Service mode. One process owns the donors, recipients, donations and
+// inventory and answers commands from local clients over a Unix domain
+// socket, so several intake desks can work at once.
+//
+// Protocol: the client sends one command per line; the server answers each
+// with text (a report, or one "OK ..." / "ERROR ..." line) followed by a
+// NUL byte. Commands:
+//   register-donor <name> <contact>
+//   donate-food <donor> <recipient-id> <kg> <DD-MM-YYYY> <food type>
+//   donate-money <donor> <recipient-id> <amount> <DD-MM-YYYY>
+//   request-food <recipient-id> <kg> [normal|urgent|critical]
+//   report donations [quantity|date|money]
+//   report distribution | donors | summary | distribution-summary | audit
+//   report range <DD-MM-YYYY> <DD-MM-YYYY>
+//   help
+//
+// Each connection is served by a worker from a thread pool, which reads and
+// parses commands concurrently. The shared state sits behind one mutex,
+// held while a command runs: commands are short, and saves only hand their
+// bytes to the GroupCommitter, so concurrent donations share fsyncs rather
+// than wait on them. Each command saves everything it changed, so a crash
+// loses at most the last commit window. A report is rendered into memory
+// with the lock held and sent once it is released, so a client that reads
+// slowly holds up only its own session.
+class DonationService {
+private:
+    DonorManager donorManager;
+    RecipientLinkedList recipients;
+    Reporting report;
+    Inventory inventory;
+    std::mutex stateMutex;
+    std::mt19937 idGenerator;
+
+    std::string socketPath;
+    int listenFd;
+    std::mutex sessionsMutex;
+    std::set<int> sessions;   // open client connections
+    ThreadPool pool;          // last, so sessions end before the state goes
+
+    static const int SEND_TIMEOUT_SECONDS = 30;
+
+    static volatile std::sig_atomic_t& stopRequested() {
+        static volatile std::sig_atomic_t requested = 0;
+        return requested;
+    }
+
+    static void onSignal(int) { stopRequested() = 1; }
+
+    static bool sendAll(int fd, const char* data, size_t size) {
+        while (size > 0) {
+            ssize_t sent = ::send(fd, data, size, MSG_NOSIGNAL);
+            if (sent < 0) {
+                if (errno == EINTR) continue;
+                return false;
+            }
+            data += sent;
+            size -= static_cast<size_t>(sent);
+        }
+        return true;
+    }
+
+    std::string registerDonor(std::istringstream& args) {
+        std::string name, contact;
+        if (!(args >> name >> contact)) return "ERROR usage: register-donor <name> <contact>";
+        if (donorManager.find_donor_by_name(name)) return "ERROR a donor named " + name + " is already registered";
+        if (donorManager.getDonors().size() >= 900) return "ERROR no donor IDs left to assign";
+        std::uniform_int_distribution<> ids(100, 999);
+        int id = ids(idGenerator);
+        while (donorManager.find_donor_by_id(id)) id = ids(idGenerator);
+        if (!donorManager.register_donor(name, contact, id)) return "ERROR cannot register " + name;
+        // Saved now: after a crash, a restart would otherwise find this
+        // donor's journaled donations orphaned and remove them.
+        donorManager.saveDonors();
+        return "OK donor " + std::to_string(id);
+    }
+
+    std::string donate(std::istringstream& args, bool money) {
+        std::string donorName, date, foodType;
+        int recipientId;
+        float amount = 0;
+        int quantity = 0;
+        bool parsed = money ? static_cast<bool>(args >> donorName >> recipientId >> amount >> date)
+                            : static_cast<bool>(args >> donorName >> recipientId >> quantity >> date);
+        if (!money && parsed) {
+            std::getline(args >> std::ws, foodType);
+            parsed = !foodType.empty();
+        }
+        if (!parsed) {
+            return money ? "ERROR usage: donate-money <donor> <recipient-id> <amount> <DD-MM-YYYY>"
+                         : "ERROR usage: donate-food <donor> <recipient-id> <kg> <DD-MM-YYYY> <food type>";
+        }
+        if (money ? amount <= 0 : quantity <= 0) return "ERROR the amount must be positive";
+        if (!isValidDate(date)) return "ERROR dates must be DD-MM-YYYY";
+        const Donor* donor = donorManager.find_donor_by_name(donorName);
+        if (!donor) return "ERROR donor " + donorName + " not found";
+        if (!recipients.findRecipientById(recipientId)) return "ERROR recipient " + std::to_string(recipientId) + " not found";
+
+        if (money) {
+            Donation donation(donor->get_id(), donorName, recipientId, amount, date);
+            processDonation(donorManager, recipients, donation);
+            report.addDonation(donation);
+        } else {
+            Donation donation(donor->get_id(), donorName, recipientId, foodType, quantity, date);
+            processDonation(donorManager, recipients, donation, &inventory);
+            report.addDonation(donation);
+        }
+        // The donor's count and the stock changed too.
+        report.forceSaveAll();
+        donorManager.saveDonors();
+        if (!money) inventory.save();
+        return "OK donation recorded";
+    }
+
+    std::string requestFood(std::istringstream& args) {
+        static const char* LEVELS[] = {"normal", "urgent", "critical"};
+        int recipientId, quantity;
+        std::string level = "normal";
+        if (!(args >> recipientId >> quantity)) return "ERROR usage: request-food <recipient-id> <kg> [normal|urgent|critical]";
+        args >> level;
+        int urgency = 0;
+        while (urgency < 3 && level != LEVELS[urgency]) urgency++;
+        if (urgency == 3) return "ERROR urgency must be normal, urgent or critical";
+        if (quantity <= 0) return "ERROR the quantity must be positive";
+        recipient* rec = recipients.findRecipientById(recipientId);
+        if (!rec) return "ERROR recipient " + std::to_string(recipientId) + " not found";
+        rec->request_food(quantity, urgency);
+        return "OK request queued";
+    }
+
+    // Renders a report into text. Returns an error line, or an empty string
+    // once the report is in text.
+    std::string runReport(std::istringstream& args, std::string& text) {
+        std::string name;
+        args >> name;
+        Date from, to;
+        if (name == "range") {
+            std::string first, last;
+            args >> first >> last;
+            from = Date::parse(first);
+            to = Date::parse(last);
+            if (!from.isValid() || !to.isValid()) return "ERROR usage: report range <DD-MM-YYYY> <DD-MM-YYYY>";
+        }
+        static const char* ORDERS[] = {"quantity", "date", "money"};
+        int order = 0;
+        if (name == "donations") {
+            std::string by = "quantity";
+            args >> by;
+            while (order < 3 && by != ORDERS[order]) order++;
+            if (order == 3) return "ERROR donations are ordered by quantity, date or money";
+        }
+
+        reportCapture() = &text;
+        bool known = true;
+        if (name == "donations") report.generateDonationReport(order);
+        else if (name == "distribution") report.generateDistributionReport();
+        else if (name == "donors") report.generateDonorReport();
+        else if (name == "summary") report.generateOverallSummary();
+        else if (name == "distribution-summary") report.generateDistributionSummary();
+        else if (name == "audit") report.generateAuditReport();
+        else if (name == "range") report.generateDateRangeReport(from, to);
+        else known = false;
+        reportCapture() = nullptr;
+        return known ? "" : "ERROR unknown report " + name;
+    }
+
+    // Runs one command and sends the reply. Returns false if the client
+    // can no longer be written to.
+    bool execute(const std::string& line, int fd) {
+        std::istringstream args(line);
+        std::string command, reply, text;
+        args >> command;
+        if (command.empty()) {
+            reply = "ERROR empty command";
+        } else if (command == "help") {
+            reply = "OK commands: register-donor, donate-food, donate-money, request-food, report";
+        } else {
+            std::lock_guard<std::mutex> lock(stateMutex);
+            if (command == "register-donor") reply = registerDonor(args);
+            else if (command == "donate-food") reply = donate(args, false);
+            else if (command == "donate-money") reply = donate(args, true);
+            else if (command == "request-food") reply = requestFood(args);
+            else if (command == "report") reply = runReport(args, text);
+            else reply = "ERROR unknown command " + command;
+        }
+        if (!reply.empty()) reply += '\n';
+        else reply.swap(text);
+        reply += '\0';
+        return sendAll(fd, reply.data(), reply.size());
+    }
+
+    // Answers commands from one client until it disconnects.
+    void serve(int fd) {
+        std::string pending;
+        char chunk[4096];
+        bool connected = true;
+        while (connected) {
+            ssize_t got = ::recv(fd, chunk, sizeof(chunk), 0);
+            if (got < 0 && errno == EINTR) continue;
+            if (got <= 0) break;
+            pending.append(chunk, static_cast<size_t>(got));
+            size_t start = 0, end;
+            while (connected && (end = pending.find('\n', start)) != std::string::npos) {
+                std::string line = pending.substr(start, end - start);
+                if (!line.empty() && line.back() == '\r') line.pop_back();
+                connected = execute(line, fd);
+                start = end + 1;
+            }
+            pending.erase(0, start);
+        }
+        {
+            std::lock_guard<std::mutex> lock(sessionsMutex);
+            sessions.erase(fd);
+        }
+        ::close(fd);
+    }
+
+    // Wakes every session blocked on its client so the pool can finish.
+    void closeSessions() {
+        std::lock_guard<std::mutex> lock(sessionsMutex);
+        for (int fd : sessions) ::shutdown(fd, SHUT_RDWR);
+    }
+
+public:
+    // workers is the most clients served at once; later ones wait for a
+    // free worker.
+    DonationService(const std::string& path, size_t workers, size_t reportThreads,
+                    const AutosaveSettings& autosave = AutosaveSettings())
+        : report(donorManager, recipients, reportThreads), idGenerator(std::random_device()()),
+          socketPath(path), listenFd(-1), pool(workers) {
+        recipients.setAutoSave(false);
+        report.cleanupOrphanedDonations(donorManager, recipients);
+        if (autosave.interval.count() > 0) recipients.startBackgroundSave(autosave);
+    }
+
+    ~DonationService() {
+        if (listenFd >= 0) {
+            ::close(listenFd);
+            ::unlink(socketPath.c_str());
+        }
+    }
+
+    DonationService(const DonationService&) = delete;
+    DonationService& operator=(const DonationService&) = delete;
+
+    // Accepts clients until SIGINT or SIGTERM. Returns 0 on a clean stop.
+    int run() {
+        sockaddr_un address;
+        std::memset(&address, 0, sizeof(address));
+        address.sun_family = AF_UNIX;
+        if (socketPath.size() >= sizeof(address.sun_path)) {
+            std::cerr << "Socket path too long: " << socketPath << std::endl;
+            return 1;
+        }
+        std::strcpy(address.sun_path, socketPath.c_str());
+
+        listenFd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        ::unlink(socketPath.c_str());
+        if (listenFd < 0 || ::bind(listenFd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+            ::listen(listenFd, 64) != 0) {
+            std::cerr << "Cannot listen on " << socketPath << ": " << std::strerror(errno) << std::endl;
+            return 1;
+        }
+
+        struct sigaction action;
+        std::memset(&action, 0, sizeof(action));
+        action.sa_handler = onSignal;
+        sigaction(SIGINT, &action, nullptr);
+        sigaction(SIGTERM, &action, nullptr);
+        // A client that hangs up must not take the service down.
+        std::signal(SIGPIPE, SIG_IGN);
+        std::cout << "Serving on " << socketPath << " with " << pool.size() << " workers" << std::endl;
+
+        pollfd listener = {listenFd, POLLIN, 0};
+        while (!stopRequested()) {
+            int ready = ::poll(&listener, 1, 200);
+            if (ready <= 0) continue;
+            int client = ::accept(listenFd, nullptr, nullptr);
+            if (client < 0) continue;
+            // A client that stops reading its replies is dropped rather than
+            // keeping a worker forever.
+            timeval timeout = {SEND_TIMEOUT_SECONDS, 0};
+            ::setsockopt(client, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+            {
+                std::lock_guard<std::mutex> lock(sessionsMutex);
+                sessions.insert(client);
+            }
+            pool.submit([this, client] { serve(client); });
+        }
+        closeSessions();
+        std::cout << "Shutting down." << std::endl;
+        return 0;
+    }
+};
+
+// Client side of the service protocol.
+class ServiceClient {
+private:
+    int fd;
+
+public:
+    ServiceClient() : fd(-1) {}
+    ~ServiceClient() { if (fd >= 0) ::close(fd); }
+
+    ServiceClient(const ServiceClient&) = delete;
+    ServiceClient& operator=(const ServiceClient&) = delete;
+
+    bool connect(const std::string& path) {
+        sockaddr_un address;
+        std::memset(&address, 0, sizeof(address));
+        address.sun_family = AF_UNIX;
+        if (path.size() >= sizeof(address.sun_path)) return false;
+        std::strcpy(address.sun_path, path.c_str());
+        fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        return fd >= 0 && ::connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0;
+    }
+
+    // Sends one command and copies the reply to stdout. Returns false if
+    // the connection is lost; an ERROR reply sets failed.
+    bool send(const std::string& command, bool& failed) {
+        std::string line = command + "\n";
+        size_t offset = 0;
+        while (offset < line.size()) {
+            ssize_t sent = ::send(fd, line.data() + offset, line.size() - offset, MSG_NOSIGNAL);
+            if (sent < 0) {
+                if (errno == EINTR) continue;
+                return false;
+            }
+            offset += static_cast<size_t>(sent);
+        }
+
+        ReportWriter out;
+        char chunk[64 * 1024];
+        bool first = true;
+        while (true) {
+            ssize_t got = ::recv(fd, chunk, sizeof(chunk), 0);
+            if (got < 0 && errno == EINTR) continue;
+            if (got <= 0) return false;
+            if (first && std::strncmp(chunk, "ERROR", std::min<size_t>(5, got)) == 0) failed = true;
+            first = false;
+            char* end = static_cast<char*>(std::memchr(chunk, '\0', static_cast<size_t>(got)));
+            out.write(chunk, end ? end - chunk : got);
+            if (end) return true;
+        }
+    }
+};
+
+#endif
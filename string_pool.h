@@ -0,0 +1,41 @@
+#ifndef STRING_POOL_H
+#define STRING_POOL_H
+
+#include <string>
+#include <deque>
+#include <cstdint>
+#include <unordered_map>
+
+// Process-wide table of interned strings. Each distinct string is stored
+// once and referred to by a 32-bit id; references returned by get() stay
+// valid for the life of the program.
+class StringPool {
+private:
+    std::deque<std::string> strings;
+    std::unordered_map<std::string, uint32_t> ids;
+
+    StringPool() { intern(""); }
+
+public:
+    static const uint32_t EMPTY = 0;
+
+    static StringPool& instance() {
+        static StringPool pool;
+        return pool;
+    }
+
+    uint32_t intern(const std::string& s) {
+        auto it = ids.find(s);
+        if (it != ids.end()) return it->second;
+        uint32_t id = static_cast<uint32_t>(strings.size());
+        strings.push_back(s);
+        ids.emplace(s, id);
+        return id;
+    }
+
+    const std::string& get(uint32_t id) const { return strings[id]; }
+
+    size_t size() const { return strings.size(); }
+};
+
+#endif